@@ -1,57 +1,252 @@
 #include "bst.h"
+#include "list-sort.h"
+#include "simd.h"
+#include <pthread.h>
+
+#define BST_SLAB_MIN_SIZE 64
+#define BST_SLAB_MAX_SIZE 4096
+#define BST_MAX_HEIGHT 128
+#define BST_BUILD_PARALLEL_THRESHOLD 65536
+
+struct bst_build_task
+{
+    const int64_t* data;
+    void** values;
+    struct node* nodes;
+    uint64_t count;
+    struct node* root;
+    uint8_t depth;
+};
 
 
 struct bst* bst_create(const bool is_avl)
 {
-    struct bst* bst = malloc(sizeof(struct bst));
+    struct bst* bst = calloc(1, sizeof(struct bst));
+    if (!bst)
+    {
+        fprintf(stderr, "bst_create: bst malloc failed\n");
+        return NULL;
+    }
     bst->is_avl = is_avl;
     bst->root = NULL;
     return bst;
 }
 
-static struct node* node_create(const int64_t data)
+struct bst* bst_create_with_comparator(const bool is_avl, int (*compare)(const int64_t, const int64_t))
+{
+    struct bst* bst = bst_create(is_avl);
+    if (!bst)
+    {
+        return NULL;
+    }
+    bst->compare = compare;
+    return bst;
+}
+
+static int compare_string(const int64_t key_a, const int64_t key_b)
+{
+    return strcmp((const char*)key_a, (const char*)key_b);
+}
+
+struct bst* bst_create_persistent(const bool is_avl)
+{
+    struct bst* bst = bst_create(is_avl);
+    if (!bst)
+    {
+        return NULL;
+    }
+    bst->is_persistent = true;
+    return bst;
+}
+
+struct bst* bst_create_typed(const bool is_avl, const bool string_type)
+{
+    return bst_create_with_comparator(is_avl, string_type ? compare_string : NULL);
+}
+
+struct bst* bst_create_btree(void)
+{
+    struct bst* bst = bst_create(false);
+    if (!bst)
+    {
+        return NULL;
+    }
+    bst->btree = btree_create();
+    if (!bst->btree)
+    {
+        free(bst);
+        return NULL;
+    }
+    return bst;
+}
+
+static int bst_compare(const struct bst* bst, const int64_t key_a, const int64_t key_b)
+{
+    if (bst->compare != NULL)
+    {
+        return bst->compare(key_a, key_b);
+    }
+    return (key_a > key_b) - (key_a < key_b);
+}
+
+static struct node* node_create(struct bst* bst, const int64_t data, void* value)
 {
-    struct node* node = malloc(sizeof(struct node));
+    struct node* node = bst->free_nodes;
+    if (node != NULL)
+    {
+        bst->free_nodes = node->left;
+    }
+    else if (bst->is_persistent)
+    {
+        node = malloc(sizeof(struct node));
+        if (!node)
+        {
+            fprintf(stderr, "node_create: node malloc failed\n");
+            return NULL;
+        }
+    }
+    else
+    {
+        if (bst->slabs == NULL || bst->slab_count == bst->slab_size)
+        {
+            uint64_t slab_size = bst->slab_size == 0 ? BST_SLAB_MIN_SIZE : bst->slab_size * 2;
+            slab_size = slab_size < BST_SLAB_MAX_SIZE ? slab_size : BST_SLAB_MAX_SIZE;
+            struct node_slab* slab = malloc(sizeof(struct node_slab) + slab_size * sizeof(struct node));
+            if (!slab)
+            {
+                fprintf(stderr, "node_create: slab malloc failed\n");
+                return NULL;
+            }
+            slab->next = bst->slabs;
+            bst->slabs = slab;
+            bst->slab_size = slab_size;
+            bst->slab_count = 0;
+        }
+        node = &bst->slabs->nodes[bst->slab_count++];
+    }
     node->data = data;
+    node->value = value;
     node->left = NULL;
     node->right = NULL;
+    node->sum = data;
+    node->size = 1;
     node->height = 0;
+    atomic_init(&node->refs, 1);
     return node;
 }
 
-static void node_destroy_recursive(struct node* node)
+static void node_destroy(struct bst* bst, struct node* node)
 {
-    if (node == NULL)
+    if (bst->is_persistent)
     {
+        free(node);
         return;
     }
-    node_destroy_recursive(node->left);
-    node_destroy_recursive(node->right);
-    free(node);
+    node->left = bst->free_nodes;
+    bst->free_nodes = node;
 }
 
-void bst_destroy(struct bst* bst)
+static bool node_reserve(struct bst* bst, const uint64_t count)
 {
-    node_destroy_recursive(bst->root);
-    free(bst);
+    uint64_t spare_count = 0;
+    for (struct node* node = bst->free_nodes; node != NULL && spare_count < count; node = node->left)
+    {
+        spare_count++;
+    }
+    for (; spare_count < count; spare_count++)
+    {
+        struct node* node = malloc(sizeof(struct node));
+        if (!node)
+        {
+            fprintf(stderr, "node_reserve: node malloc failed\n");
+            return false;
+        }
+        node->left = bst->free_nodes;
+        bst->free_nodes = node;
+    }
+    return true;
 }
 
-static struct node* avl_rotate_left(struct node** node)
+static void node_retain(struct node* node)
 {
-    struct node* right = (*node)->right;
-    struct node* right_left = right->left;
-    right->left = *node;
-    (*node)->right = right_left;
-    return right;
+    if (node != NULL)
+    {
+        atomic_fetch_add(&node->refs, 1);
+    }
 }
 
-static struct node* avl_rotate_right(struct node** node)
+static void node_release(struct node* node)
 {
-    struct node* left = (*node)->left;
-    struct node* left_right = left->right;
-    left->right = *node;
-    (*node)->left = left_right;
-    return left;
+    if (node == NULL || atomic_fetch_sub(&node->refs, 1) != 1)
+    {
+        return;
+    }
+    node->value = NULL;
+    while (node != NULL)
+    {
+        struct node* dead = node;
+        node = dead->value;
+        if (dead->left != NULL && atomic_fetch_sub(&dead->left->refs, 1) == 1)
+        {
+            dead->left->value = node;
+            node = dead->left;
+        }
+        if (dead->right != NULL && atomic_fetch_sub(&dead->right->refs, 1) == 1)
+        {
+            dead->right->value = node;
+            node = dead->right;
+        }
+        free(dead);
+    }
+}
+
+static struct node* node_unshare(struct bst* bst, struct node* node)
+{
+    if (!bst->is_persistent || atomic_load(&node->refs) == 1)
+    {
+        return node;
+    }
+    struct node* copy = node_create(bst, node->data, node->value);
+    copy->left = node->left;
+    copy->right = node->right;
+    copy->sum = node->sum;
+    copy->size = node->size;
+    copy->height = node->height;
+    node_retain(copy->left);
+    node_retain(copy->right);
+    node_release(node);
+    return copy;
+}
+
+static void node_slabs_destroy(struct node_slab* slab)
+{
+    while (slab != NULL)
+    {
+        struct node_slab* next = slab->next;
+        free(slab);
+        slab = next;
+    }
+}
+
+void bst_destroy(struct bst* bst)
+{
+    bst_unfreeze(bst);
+    if (bst->btree != NULL)
+    {
+        btree_destroy(bst->btree);
+    }
+    if (bst->is_persistent)
+    {
+        node_release(bst->root);
+        while (bst->free_nodes != NULL)
+        {
+            struct node* node = bst->free_nodes;
+            bst->free_nodes = node->left;
+            free(node);
+        }
+    }
+    node_slabs_destroy(bst->slabs);
+    free(bst);
 }
 
 static int16_t avl_get_height(const struct node* node)
@@ -63,19 +258,54 @@ static int16_t avl_get_height(const struct node* node)
     return node->height;
 }
 
-static void avl_set_height(struct node* node)
+static uint64_t node_get_size(const struct node* node)
 {
     if (node == NULL)
     {
-        return;
+        return 0;
+    }
+    return node->size;
+}
+
+static int64_t node_get_sum(const struct node* node)
+{
+    if (node == NULL)
+    {
+        return 0;
     }
-    avl_set_height(node->left);
-    avl_set_height(node->right);
+    return node->sum;
+}
 
+static void node_update(struct node* node)
+{
     int16_t left_height = avl_get_height(node->left);
     int16_t right_height = avl_get_height(node->right);
 
     node->height = 1 + (left_height >= right_height ? left_height : right_height);
+    node->size = 1 + node_get_size(node->left) + node_get_size(node->right);
+    node->sum = (int64_t)((uint64_t)node->data + (uint64_t)node_get_sum(node->left) + (uint64_t)node_get_sum(node->right));
+}
+
+static struct node* avl_rotate_left(struct node** node)
+{
+    struct node* right = (*node)->right;
+    struct node* right_left = right->left;
+    right->left = *node;
+    (*node)->right = right_left;
+    node_update(*node);
+    node_update(right);
+    return right;
+}
+
+static struct node* avl_rotate_right(struct node** node)
+{
+    struct node* left = (*node)->left;
+    struct node* left_right = left->right;
+    left->right = *node;
+    (*node)->left = left_right;
+    node_update(*node);
+    node_update(left);
+    return left;
 }
 
 static int16_t avl_balance_factor(const struct node* node)
@@ -108,228 +338,1103 @@ static struct node* avl_balance(struct node** node)
     return *node;
 }
 
-static void insert_recursive(struct node** node, const int64_t data, const bool is_avl)
+static void avl_unshare_rotation(struct bst* bst, struct node* node)
 {
-    if (*node == NULL)
-    {
-        *node = node_create(data);
-    }
-    else if (data <= (*node)->data)
-    {
-        insert_recursive(&(*node)->left, data, is_avl);
-    }
-    else if (data > (*node)->data)
+    if (avl_balance_factor(node) < -1)
     {
-        insert_recursive(&(*node)->right, data, is_avl);
+        node->right = node_unshare(bst, node->right);
+        if (avl_balance_factor(node->right) > 0)
+        {
+            node->right->left = node_unshare(bst, node->right->left);
+        }
     }
-    if (is_avl)
+    else if (avl_balance_factor(node) > 1)
     {
-        avl_set_height(*node);
-        *node = avl_balance(node);
+        node->left = node_unshare(bst, node->left);
+        if (avl_balance_factor(node->left) < 0)
+        {
+            node->left->right = node_unshare(bst, node->left->right);
+        }
     }
 }
 
-void bst_insert(struct bst* bst, const int64_t data)
+static void avl_rebalance_path(struct bst* bst, struct node*** path, uint64_t depth)
 {
-    insert_recursive(&bst->root, data, bst->is_avl);
+    while (depth > 0)
+    {
+        struct node** link = path[--depth];
+        int16_t height = (*link)->height;
+        node_update(*link);
+        if (bst->is_persistent)
+        {
+            avl_unshare_rotation(bst, *link);
+        }
+        *link = avl_balance(link);
+        if ((*link)->height == height)
+        {
+            return;
+        }
+    }
 }
 
-static struct node* get_min_child(struct node* node)
+static uint64_t node_path_length(const struct bst* bst, const int64_t data, const bool is_remove)
 {
-    if (node->left == NULL)
+    uint64_t length = 0;
+    const struct node* node = bst->root;
+    while (node != NULL)
     {
-        return node;
+        length++;
+        int order = bst_compare(bst, data, node->data);
+        if (is_remove && order == 0)
+        {
+            if (node->left != NULL && node->right != NULL)
+            {
+                for (node = node->right; node != NULL; node = node->left)
+                {
+                    length++;
+                }
+            }
+            return length;
+        }
+        node = order < 0 || (!is_remove && order == 0) ? node->left : node->right;
     }
-    return get_min_child(node);
+    return length;
 }
 
-struct node* remove_recursive(struct node** node, const int64_t data, const bool is_avl)
+static bool node_reserve_path(struct bst* bst, const int64_t data, const bool is_remove)
 {
-    if (*node == NULL)
+    if (!bst->is_persistent)
     {
-        return NULL;
+        return true;
     }
+    uint64_t length = node_path_length(bst, data, is_remove);
+    return node_reserve(bst, (bst->is_avl ? 3 * length : length) + 1);
+}
 
-    else if (data < (*node)->data)
+static void insert_node(struct bst* bst, const int64_t data, void* value)
+{
+    if (!node_reserve_path(bst, data, false))
     {
-        (*node)->left = remove_recursive(&(*node)->left, data, is_avl);
+        return;
     }
-    else if (data > (*node)->data)
+    struct node* node = node_create(bst, data, value);
+    if (!node)
     {
-        (*node)->right = remove_recursive(&(*node)->right, data, is_avl);
+        return;
     }
 
-    else if ((*node)->left == NULL)
+    struct node** path[BST_MAX_HEIGHT];
+    uint64_t depth = 0;
+    struct node** link = &bst->root;
+    while (*link != NULL)
     {
-        *node = (*node)->right;
-    }
-    else if ((*node)->right == NULL)
-    {
-        *node = (*node)->left;
-    }
-    else
-    {
-        struct node* right_min_child = get_min_child((*node)->right);
-        (*node)->data = right_min_child->data;
-        (*node)->right = remove_recursive(&(*node)->right, right_min_child->data, is_avl);
+        *link = node_unshare(bst, *link);
+        if (bst->is_avl)
+        {
+            path[depth++] = link;
+        }
+        (*link)->size++;
+        (*link)->sum = (int64_t)((uint64_t)(*link)->sum + (uint64_t)data);
+        link = bst_compare(bst, data, (*link)->data) <= 0 ? &(*link)->left : &(*link)->right;
     }
-    
-    if (is_avl)
+    *link = node;
+
+    if (bst->is_avl)
     {
-        avl_set_height(*node);
-        return avl_balance(node);
+        avl_rebalance_path(bst, path, depth);
     }
-    return *node;
 }
 
-void bst_remove(struct bst* bst, int64_t data)
+void bst_insert(struct bst* bst, const int64_t data)
 {
-    remove_recursive(&bst->root, data, bst->is_avl);
+    bst_unfreeze(bst);
+    if (bst->btree != NULL)
+    {
+        btree_insert(bst->btree, data);
+        return;
+    }
+    insert_node(bst, data, NULL);
 }
 
-
-int64_t get_recursive(const struct node* node, const int64_t data)
+static struct node* find_node(const struct bst* bst, const int64_t data)
 {
-    if (node == NULL)
+    struct node* node = bst->root;
+    while (node != NULL)
     {
-        fprintf(stderr, "bst_get: data not in tree.");
-        return 0;
+        int order = bst_compare(bst, data, node->data);
+        if (order == 0)
+        {
+            return node;
+        }
+        node = order < 0 ? node->left : node->right;
     }
-    if (data == node->data)
+    return NULL;
+}
+
+void bst_put(struct bst* bst, const int64_t key, void* value)
+{
+    if (bst->btree != NULL)
     {
-        return node->data;
+        fprintf(stderr, "bst_put: values not supported in btree mode\n");
+        return;
     }
-    if (data < node->data)
+    struct node* node = find_node(bst, key);
+    if (node != NULL && bst->is_persistent)
     {
-        return get_recursive(node->left, data);
+        if (!node_reserve_path(bst, key, false))
+        {
+            return;
+        }
+        struct node** link = &bst->root;
+        while (true)
+        {
+            *link = node_unshare(bst, *link);
+            int order = bst_compare(bst, key, (*link)->data);
+            if (order == 0)
+            {
+                break;
+            }
+            link = order < 0 ? &(*link)->left : &(*link)->right;
+        }
+        node = *link;
     }
-    if (data > node->data)
+    if (node != NULL)
     {
-        return get_recursive(node->right, data);
+        node->value = value;
+        return;
     }
-    return 0;
+    bst_unfreeze(bst);
+    insert_node(bst, key, value);
 }
 
-int64_t bst_get(const struct bst* bst, const int64_t data)
+void* bst_get_value(const struct bst* bst, const int64_t key)
 {
-    return get_recursive(bst->root, data);
+    if (bst->btree != NULL)
+    {
+        fprintf(stderr, "bst_get_value: values not supported in btree mode\n");
+        return NULL;
+    }
+    struct node* node = find_node(bst, key);
+    return node != NULL ? node->value : NULL;
 }
 
-int64_t contains_recursive(const struct node* node, const int64_t data)
+static struct node* get_min_child(struct node* node)
 {
-    if (node == NULL)
+    while (node->left != NULL)
     {
-        return false;
+        node = node->left;
     }
-    if (data == node->data)
+    return node;
+}
+
+void bst_remove(struct bst* bst, const int64_t data)
+{
+    bst_unfreeze(bst);
+    if (bst->btree != NULL)
     {
-        return true;
+        btree_remove(bst->btree, data);
+        return;
     }
-    if (data < node->data)
+    if (bst->is_persistent && (find_node(bst, data) == NULL || !node_reserve_path(bst, data, true)))
     {
-        return contains_recursive(node->left, data);
+        return;
     }
-    if (data > node->data)
+
+    struct node** path[BST_MAX_HEIGHT];
+    uint64_t depth = 0;
+    struct node** link = &bst->root;
+    while (*link != NULL && bst_compare(bst, data, (*link)->data) != 0)
     {
-        return contains_recursive(node->right, data);
+        *link = node_unshare(bst, *link);
+        if (bst->is_avl)
+        {
+            path[depth++] = link;
+        }
+        (*link)->size--;
+        (*link)->sum = (int64_t)((uint64_t)(*link)->sum - (uint64_t)data);
+        link = bst_compare(bst, data, (*link)->data) < 0 ? &(*link)->left : &(*link)->right;
     }
-    return false;
-}
-
-bool bst_contains(const struct bst* bst, const int64_t data)
-{
-    return contains_recursive(bst->root, data);
-}
-
-
-void get_range_recursive(const struct node* node, const int64_t from, const int64_t to, struct list* list)
-{
-    if (node == NULL)
+    if (*link == NULL)
     {
+        for (struct node* node = bst->root; node != NULL; node = bst_compare(bst, data, node->data) < 0 ? node->left : node->right)
+        {
+            node->size++;
+            node->sum = (int64_t)((uint64_t)node->sum + (uint64_t)data);
+        }
         return;
     }
-    if (node->data >= from)
+
+    struct node* node = *link = node_unshare(bst, *link);
+    if (node->left != NULL && node->right != NULL)
     {
-        get_range_recursive(node->left, from, to, list);
+        if (bst->is_avl)
+        {
+            path[depth++] = link;
+        }
+        node->size--;
+        node->sum = (int64_t)((uint64_t)node->sum - (uint64_t)data);
+        int64_t min_data = get_min_child(node->right)->data;
+        struct node** min_link = &node->right;
+        *min_link = node_unshare(bst, *min_link);
+        while ((*min_link)->left != NULL)
+        {
+            if (bst->is_avl)
+            {
+                path[depth++] = min_link;
+            }
+            (*min_link)->size--;
+            (*min_link)->sum = (int64_t)((uint64_t)(*min_link)->sum - (uint64_t)min_data);
+            min_link = &(*min_link)->left;
+            *min_link = node_unshare(bst, *min_link);
+        }
+        struct node* min_child = *min_link;
+        node->data = min_child->data;
+        node->value = min_child->value;
+        *min_link = min_child->right;
+        node_destroy(bst, min_child);
     }
-    if (node->data >= from && node->data <= to)
+    else
     {
-        list_append(list, (void*)node->data);
+        *link = node->left != NULL ? node->left : node->right;
+        node_destroy(bst, node);
     }
-    if (node->data <= to)
+
+    if (bst->is_avl)
     {
-        get_range_recursive(node->right, from, to, list);
+        avl_rebalance_path(bst, path, depth);
     }
 }
 
-struct list* bst_get_range(const struct bst* bst, const int64_t from, const int64_t to)
-{
-    struct list* list = list_create(32);
-    get_range_recursive(bst->root, from, to, list);
-    return list;
-}
 
-int64_t bst_get_min(const struct bst* bst)
+struct bst* bst_snapshot(const struct bst* bst)
 {
-    return get_min_child(bst->root)->data;
+    if (!bst->is_persistent)
+    {
+        fprintf(stderr, "bst_snapshot: tree is not persistent\n");
+        return NULL;
+    }
+    struct bst* snapshot = bst_create_with_comparator(bst->is_avl, bst->compare);
+    if (!snapshot)
+    {
+        return NULL;
+    }
+    snapshot->is_persistent = true;
+    node_retain(bst->root);
+    snapshot->root = bst->root;
+    return snapshot;
 }
 
-int16_t node_height_recursive(const struct node* node)
+
+int64_t bst_get(const struct bst* bst, const int64_t data)
 {
-    if (node == NULL)
+    if (bst->frozen != NULL)
     {
+        uint64_t index = list_eytzinger_lower_bound_slot(bst->frozen, data);
+        if (index < bst->frozen->count && (int64_t)list_get(bst->frozen, index) == data)
+        {
+            return data;
+        }
+        fprintf(stderr, "bst_get: data not in tree\n");
         return 0;
     }
-    int16_t left_height = node_height_recursive(node->left);
-    int16_t right_height = node_height_recursive(node->right);
-    return 1 + (left_height >= right_height ? left_height : right_height);
+    if (bst->btree != NULL && btree_contains(bst->btree, data))
+    {
+        return data;
+    }
+    const struct node* node = find_node(bst, data);
+    if (node != NULL)
+    {
+        return node->data;
+    }
+    fprintf(stderr, "bst_get: data not in tree\n");
+    return 0;
 }
 
-int64_t get_diameter_recursive(const struct node* node, const int64_t cur_max)
+bool bst_contains(const struct bst* bst, const int64_t data)
 {
-    if (node == NULL)
+    if (bst->frozen != NULL)
     {
-        return 0;
+        uint64_t index = list_eytzinger_lower_bound_slot(bst->frozen, data);
+        return index < bst->frozen->count && (int64_t)list_get(bst->frozen, index) == data;
     }
-    int16_t left_height = node_height_recursive(node->left);
-    int16_t right_height = node_height_recursive(node->right);
-
-    int64_t node_diameter =  left_height + right_height;
-    if (node_diameter <= cur_max)
+    if (bst->btree != NULL)
     {
-        return cur_max;
+        return btree_contains(bst->btree, data);
     }
-    return left_height >= right_height ? get_diameter_recursive(node->left, node_diameter) : get_diameter_recursive(node->right, node_diameter);
+    return find_node(bst, data) != NULL;
 }
 
-int64_t bst_get_diameter(const struct bst* bst)
+
+struct list* bst_get_range(const struct bst* bst, const int64_t from, const int64_t to)
 {
-    return get_diameter_recursive(bst->root, 0);
+    return bst_get_range_limit(bst, from, to, UINT64_MAX);
 }
 
+struct list* bst_get_range_limit(const struct bst* bst, const int64_t from, const int64_t to, const uint64_t limit)
+{
+    struct list* list = list_create(32);
+    if (!list)
+    {
+        return NULL;
+    }
+    if (bst->btree != NULL)
+    {
+        btree_get_range(bst->btree, from, to, limit, list);
+        return list;
+    }
+    struct bst_cursor* cursor = bst_cursor_create(bst);
+    if (!cursor)
+    {
+        list_destroy(list);
+        return NULL;
+    }
+    bool is_valid = bst_cursor_seek(cursor, from);
+    while (is_valid && list->count < limit && bst_compare(bst, bst_cursor_get(cursor), to) <= 0)
+    {
+        list_append(list, (void*)bst_cursor_get(cursor));
+        is_valid = bst_cursor_next(cursor);
+    }
+    bst_cursor_destroy(cursor);
+    return list;
+}
 
-static void print_int_recursive(const struct bst* bst, struct node* node, const char* prefix, const bool is_left)
+static uint64_t count_less(const struct bst* bst, const int64_t data, const bool is_inclusive)
 {
-    printf("\n%s", prefix);
-    char next_prefix[128];
-    strcpy(next_prefix, prefix);
+    uint64_t count = 0;
+    const struct node* node = bst->root;
+    while (node != NULL)
+    {
+        int order = bst_compare(bst, node->data, data);
+        if (order < 0 || (is_inclusive && order == 0))
+        {
+            count += node_get_size(node->left) + 1;
+            node = node->right;
+        }
+        else
+        {
+            node = node->left;
+        }
+    }
+    return count;
+}
 
-    if (node != bst->root)
+uint64_t bst_count_range(const struct bst* bst, const int64_t from, const int64_t to)
+{
+    if (bst->btree != NULL)
     {
-        printf("%s", is_left ? "├──" : "└──");
-        strcat(next_prefix, is_left ? "│  " : "   ");
+        return btree_count_range(bst->btree, from, to);
     }
-    if (node == NULL)
+    if (bst_compare(bst, from, to) > 0)
+    {
+        return 0;
+    }
+    return count_less(bst, to, true) - count_less(bst, from, false);
+}
+
+uint64_t bst_rank(const struct bst* bst, const int64_t data)
+{
+    if (bst->btree != NULL)
+    {
+        return btree_rank(bst->btree, data);
+    }
+    return count_less(bst, data, false);
+}
+
+int64_t bst_select(const struct bst* bst, const uint64_t index)
+{
+    if (bst->btree != NULL)
+    {
+        int64_t key = 0;
+        if (!btree_select(bst->btree, index, &key))
+        {
+            fprintf(stderr, "bst_select: index out of bounds\n");
+        }
+        return key;
+    }
+    if (index >= node_get_size(bst->root))
+    {
+        fprintf(stderr, "bst_select: index out of bounds\n");
+        return 0;
+    }
+    const struct node* node = bst->root;
+    uint64_t rank = index;
+    while (true)
+    {
+        uint64_t left_size = node_get_size(node->left);
+        if (rank == left_size)
+        {
+            return node->data;
+        }
+        if (rank < left_size)
+        {
+            node = node->left;
+        }
+        else
+        {
+            rank -= left_size + 1;
+            node = node->right;
+        }
+    }
+}
+
+int64_t bst_get_min(const struct bst* bst)
+{
+    if (bst->btree != NULL)
+    {
+        return btree_get_min(bst->btree);
+    }
+    if (bst->root == NULL)
+    {
+        fprintf(stderr, "bst_get_min: tree is empty\n");
+        return 0;
+    }
+    return get_min_child(bst->root)->data;
+}
+
+bool bst_freeze(struct bst* bst)
+{
+    bst_unfreeze(bst);
+    if (bst->compare != NULL)
+    {
+        fprintf(stderr, "bst_freeze: not supported with a comparator\n");
+        return false;
+    }
+    struct list* sorted = bst_get_range(bst, INT64_MIN, INT64_MAX);
+    if (!sorted)
+    {
+        return false;
+    }
+    bst->frozen = list_to_eytzinger(sorted);
+    list_destroy(sorted);
+    return bst->frozen != NULL;
+}
+
+void bst_unfreeze(struct bst* bst)
+{
+    if (bst->frozen != NULL)
+    {
+        list_destroy(bst->frozen);
+        bst->frozen = NULL;
+    }
+}
+
+bool bst_is_frozen(const struct bst* bst)
+{
+    return bst->frozen != NULL;
+}
+
+struct bst_cursor* bst_cursor_create(const struct bst* bst)
+{
+    struct bst_cursor* cursor = calloc(1, sizeof(struct bst_cursor));
+    if (!cursor)
+    {
+        fprintf(stderr, "bst_cursor_create: cursor malloc failed\n");
+        return NULL;
+    }
+    cursor->bst = bst;
+    cursor->stack = list_create(32);
+    if (!cursor->stack)
+    {
+        free(cursor);
+        return NULL;
+    }
+    return cursor;
+}
+
+void bst_cursor_destroy(struct bst_cursor* cursor)
+{
+    list_destroy(cursor->stack);
+    free(cursor);
+}
+
+static const struct node* cursor_top(const struct bst_cursor* cursor)
+{
+    return cursor->stack->data[cursor->stack->count];
+}
+
+static void cursor_push_edge(struct bst_cursor* cursor, const struct node* node, const bool is_left)
+{
+    while (node != NULL)
+    {
+        list_append(cursor->stack, (void*)node);
+        node = is_left ? node->left : node->right;
+    }
+}
+
+static bool cursor_step(struct bst_cursor* cursor, const bool is_forward)
+{
+    const struct node* node = cursor_top(cursor);
+    const struct node* child = is_forward ? node->right : node->left;
+    if (child != NULL)
+    {
+        cursor_push_edge(cursor, child, is_forward);
+        return true;
+    }
+    cursor->stack->count--;
+    while (cursor->stack->count > 0)
+    {
+        const struct node* parent = cursor_top(cursor);
+        if ((is_forward ? parent->left : parent->right) == node)
+        {
+            return true;
+        }
+        node = parent;
+        cursor->stack->count--;
+    }
+    return false;
+}
+
+bool bst_cursor_seek(struct bst_cursor* cursor, const int64_t from)
+{
+    if (cursor->bst->btree != NULL)
+    {
+        cursor->leaf = btree_seek(cursor->bst->btree, from, &cursor->leaf_index);
+        return cursor->leaf != NULL;
+    }
+
+    list_clear(cursor->stack);
+    uint64_t found_count = 0;
+    const struct node* node = cursor->bst->root;
+    while (node != NULL)
+    {
+        list_append(cursor->stack, (void*)node);
+        if (bst_compare(cursor->bst, node->data, from) >= 0)
+        {
+            found_count = cursor->stack->count;
+            node = node->left;
+        }
+        else
+        {
+            node = node->right;
+        }
+    }
+    cursor->stack->count = found_count;
+    return found_count > 0;
+}
+
+bool bst_cursor_seek_first(struct bst_cursor* cursor)
+{
+    if (cursor->bst->btree != NULL)
+    {
+        return bst_cursor_seek(cursor, INT64_MIN);
+    }
+    list_clear(cursor->stack);
+    cursor_push_edge(cursor, cursor->bst->root, true);
+    return cursor->stack->count > 0;
+}
+
+bool bst_cursor_next(struct bst_cursor* cursor)
+{
+    if (!bst_cursor_is_valid(cursor))
+    {
+        return false;
+    }
+    if (cursor->bst->btree != NULL)
+    {
+        if (++cursor->leaf_index == cursor->leaf->node.count)
+        {
+            cursor->leaf = cursor->leaf->next;
+            cursor->leaf_index = 0;
+        }
+        return cursor->leaf != NULL;
+    }
+    return cursor_step(cursor, true);
+}
+
+bool bst_cursor_prev(struct bst_cursor* cursor)
+{
+    if (!bst_cursor_is_valid(cursor))
+    {
+        return false;
+    }
+    if (cursor->bst->btree != NULL)
+    {
+        if (cursor->leaf_index > 0)
+        {
+            cursor->leaf_index--;
+            return true;
+        }
+        cursor->leaf = btree_prev_leaf(cursor->bst->btree, cursor->leaf);
+        cursor->leaf_index = cursor->leaf != NULL ? cursor->leaf->node.count - 1 : 0;
+        return cursor->leaf != NULL;
+    }
+    return cursor_step(cursor, false);
+}
+
+bool bst_cursor_is_valid(const struct bst_cursor* cursor)
+{
+    if (cursor->bst->btree != NULL)
+    {
+        return cursor->leaf != NULL;
+    }
+    return cursor->stack->count > 0;
+}
+
+int64_t bst_cursor_get(const struct bst_cursor* cursor)
+{
+    if (!bst_cursor_is_valid(cursor))
+    {
+        fprintf(stderr, "bst_cursor_get: cursor is not valid\n");
+        return 0;
+    }
+    if (cursor->bst->btree != NULL)
+    {
+        return cursor->leaf->node.keys[cursor->leaf_index];
+    }
+    return cursor_top(cursor)->data;
+}
+
+void* bst_cursor_get_value(const struct bst_cursor* cursor)
+{
+    if (cursor->bst->btree != NULL || !bst_cursor_is_valid(cursor))
+    {
+        return NULL;
+    }
+    return cursor_top(cursor)->value;
+}
+
+void bst_for_each_range(const struct bst* bst, const int64_t from, const int64_t to, bool (*callback)(const int64_t data, void* context), void* context)
+{
+    struct bst_cursor* cursor = bst_cursor_create(bst);
+    if (!cursor)
     {
-        printf("()");
         return;
     }
-    printf("%lld", node->data);
-    print_int_recursive(bst, node->left, next_prefix, true);
-    print_int_recursive(bst, node->right, next_prefix, false);
+    bool is_valid = bst_cursor_seek(cursor, from);
+    while (is_valid && bst_compare(bst, bst_cursor_get(cursor), to) <= 0 && callback(bst_cursor_get(cursor), context))
+    {
+        is_valid = bst_cursor_next(cursor);
+    }
+    bst_cursor_destroy(cursor);
 }
 
+
+static void* build_recursive(void* arg)
+{
+    struct bst_build_task* task = arg;
+    if (task->count == 0)
+    {
+        task->root = NULL;
+        return NULL;
+    }
+
+    uint64_t middle_index = task->count / 2;
+    uint8_t depth = task->depth > 0 ? task->depth - 1 : 0;
+    void** high_values = task->values != NULL ? task->values + middle_index + 1 : NULL;
+    struct bst_build_task low_task = { task->data, task->values, task->nodes, middle_index, NULL, depth };
+    struct bst_build_task high_task = { task->data + middle_index + 1, high_values, task->nodes + middle_index + 1, task->count - middle_index - 1, NULL, depth };
+
+    pthread_t thread;
+    bool is_forked = task->depth > 0 && task->count >= BST_BUILD_PARALLEL_THRESHOLD && !pthread_create(&thread, NULL, build_recursive, &low_task);
+    if (!is_forked)
+    {
+        build_recursive(&low_task);
+    }
+    build_recursive(&high_task);
+    if (is_forked)
+    {
+        pthread_join(thread, NULL);
+    }
+
+    struct node* node = &task->nodes[middle_index];
+    node->data = task->data[middle_index];
+    node->value = task->values != NULL ? task->values[middle_index] : NULL;
+    node->left = low_task.root;
+    node->right = high_task.root;
+    node_update(node);
+    task->root = node;
+    return NULL;
+}
+
+static bool bst_build(struct bst* bst, const int64_t* data, void** values, const uint64_t count)
+{
+    struct node_slab* slab = malloc(sizeof(struct node_slab) + (count > 0 ? count : 1) * sizeof(struct node));
+    if (!slab)
+    {
+        fprintf(stderr, "bst_build: slab malloc failed\n");
+        return false;
+    }
+    struct bst_build_task task = { data, values, slab->nodes, count, NULL, list_sort_thread_depth() };
+    build_recursive(&task);
+
+    node_slabs_destroy(bst->slabs);
+    slab->next = NULL;
+    bst->slabs = slab;
+    bst->slab_size = count;
+    bst->slab_count = count;
+    bst->free_nodes = NULL;
+    bst->root = task.root;
+    return true;
+}
+
+struct bst* bst_create_from_sorted(const int64_t* data, const uint64_t count, const bool is_avl)
+{
+    if (!simd_is_sorted_int64(data, count))
+    {
+        fprintf(stderr, "bst_create_from_sorted: data is not sorted\n");
+        return NULL;
+    }
+    struct bst* bst = bst_create(is_avl);
+    if (!bst)
+    {
+        return NULL;
+    }
+    if (!bst_build(bst, data, NULL, count))
+    {
+        free(bst);
+        return NULL;
+    }
+    return bst;
+}
+
+static bool is_sorted_keys(const struct bst* bst, const int64_t* data, const uint64_t count)
+{
+    if (bst->compare == NULL)
+    {
+        return simd_is_sorted_int64(data, count);
+    }
+    for (uint64_t i = 1; i < count; i++)
+    {
+        if (bst->compare(data[i - 1], data[i]) > 0)
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+void bst_bulk_insert(struct bst* bst, const int64_t* data, const uint64_t count)
+{
+    if (!is_sorted_keys(bst, data, count))
+    {
+        fprintf(stderr, "bst_bulk_insert: data is not sorted\n");
+        return;
+    }
+    bst_unfreeze(bst);
+    uint64_t tree_count = node_get_size(bst->root);
+    if (bst->btree != NULL || bst->is_persistent || (tree_count > 0 && count * (64 - __builtin_clzll(tree_count)) < tree_count))
+    {
+        for (uint64_t i = 0; i < count; i++)
+        {
+            bst_insert(bst, data[i]);
+        }
+        return;
+    }
+    if (tree_count == 0)
+    {
+        bst_build(bst, data, NULL, count);
+        return;
+    }
+
+    int64_t* merged = malloc((tree_count + count) * sizeof(int64_t));
+    void** merged_values = calloc(tree_count + count, sizeof(void*));
+    struct bst_cursor* cursor = bst_cursor_create(bst);
+    if (!merged || !merged_values || !cursor)
+    {
+        fprintf(stderr, "bst_bulk_insert: merge buffer malloc failed\n");
+        free(merged);
+        free(merged_values);
+        if (cursor)
+        {
+            bst_cursor_destroy(cursor);
+        }
+        return;
+    }
+
+    uint64_t index = 0;
+    uint64_t merged_count = 0;
+    bool is_valid = bst_cursor_seek_first(cursor);
+    while (is_valid || index < count)
+    {
+        if (is_valid && (index == count || bst_compare(bst, bst_cursor_get(cursor), data[index]) <= 0))
+        {
+            merged_values[merged_count] = bst_cursor_get_value(cursor);
+            merged[merged_count++] = bst_cursor_get(cursor);
+            is_valid = bst_cursor_next(cursor);
+        }
+        else
+        {
+            merged[merged_count++] = data[index++];
+        }
+    }
+    bst_cursor_destroy(cursor);
+    bst_build(bst, merged, merged_values, merged_count);
+    free(merged);
+    free(merged_values);
+}
+
+
+int64_t bst_get_diameter(const struct bst* bst)
+{
+    if (bst->btree != NULL)
+    {
+        fprintf(stderr, "bst_get_diameter: not supported in btree mode\n");
+        return 0;
+    }
+    if (bst->root == NULL)
+    {
+        return 0;
+    }
+
+    struct list* stack = list_create(32);
+    struct list* heights = list_create(32);
+    if (!stack || !heights)
+    {
+        if (stack)
+        {
+            list_destroy(stack);
+        }
+        if (heights)
+        {
+            list_destroy(heights);
+        }
+        return 0;
+    }
+
+    int64_t diameter = 0;
+    const struct node* prev = NULL;
+    list_append(stack, bst->root);
+    while (stack->count > 0)
+    {
+        const struct node* node = stack->data[stack->count];
+        bool is_descending = prev == NULL || prev->left == node || prev->right == node;
+        if (is_descending && node->left != NULL)
+        {
+            list_append(stack, node->left);
+        }
+        else if ((is_descending || prev == node->left) && node->right != NULL)
+        {
+            list_append(stack, node->right);
+        }
+        else
+        {
+            int64_t right_height = node->right != NULL ? (int64_t)heights->data[heights->count--] : -1;
+            int64_t left_height = node->left != NULL ? (int64_t)heights->data[heights->count--] : -1;
+            diameter = left_height + right_height + 2 > diameter ? left_height + right_height + 2 : diameter;
+            list_append(heights, (void*)(1 + (left_height >= right_height ? left_height : right_height)));
+            stack->count--;
+        }
+        prev = node;
+    }
+
+    list_destroy(stack);
+    list_destroy(heights);
+    return diameter;
+}
+
+static int64_t sum_less(const struct bst* bst, const int64_t data, const bool is_inclusive)
+{
+    uint64_t sum = 0;
+    const struct node* node = bst->root;
+    while (node != NULL)
+    {
+        int order = bst_compare(bst, node->data, data);
+        if (order < 0 || (is_inclusive && order == 0))
+        {
+            sum += (uint64_t)node_get_sum(node->left) + (uint64_t)node->data;
+            node = node->right;
+        }
+        else
+        {
+            node = node->left;
+        }
+    }
+    return (int64_t)sum;
+}
+
+static const struct node* node_ceiling(const struct bst* bst, const int64_t data, const bool is_inclusive)
+{
+    const struct node* ceiling = NULL;
+    const struct node* node = bst->root;
+    while (node != NULL)
+    {
+        int order = bst_compare(bst, node->data, data);
+        if (order > 0 || (is_inclusive && order == 0))
+        {
+            ceiling = node;
+            node = node->left;
+        }
+        else
+        {
+            node = node->right;
+        }
+    }
+    return ceiling;
+}
+
+static const struct node* node_floor(const struct bst* bst, const int64_t data, const bool is_inclusive)
+{
+    const struct node* floor = NULL;
+    const struct node* node = bst->root;
+    while (node != NULL)
+    {
+        int order = bst_compare(bst, node->data, data);
+        if (order < 0 || (is_inclusive && order == 0))
+        {
+            floor = node;
+            node = node->right;
+        }
+        else
+        {
+            node = node->left;
+        }
+    }
+    return floor;
+}
+
+static bool ceiling_key(const struct bst* bst, const int64_t data, const bool is_inclusive, int64_t* key)
+{
+    if (bst->btree != NULL)
+    {
+        if (!is_inclusive && data == INT64_MAX)
+        {
+            return false;
+        }
+        uint16_t index = 0;
+        struct btree_leaf* leaf = btree_seek(bst->btree, is_inclusive ? data : data + 1, &index);
+        if (leaf == NULL)
+        {
+            return false;
+        }
+        *key = leaf->node.keys[index];
+        return true;
+    }
+    const struct node* node = node_ceiling(bst, data, is_inclusive);
+    if (node == NULL)
+    {
+        return false;
+    }
+    *key = node->data;
+    return true;
+}
+
+static bool floor_key(const struct bst* bst, const int64_t data, const bool is_inclusive, int64_t* key)
+{
+    if (bst->btree != NULL)
+    {
+        if (!is_inclusive && data == INT64_MIN)
+        {
+            return false;
+        }
+        return btree_floor(bst->btree, is_inclusive ? data : data - 1, key);
+    }
+    const struct node* node = node_floor(bst, data, is_inclusive);
+    if (node == NULL)
+    {
+        return false;
+    }
+    *key = node->data;
+    return true;
+}
+
+bool bst_ceiling(const struct bst* bst, const int64_t data, int64_t* ceiling)
+{
+    return ceiling_key(bst, data, true, ceiling);
+}
+
+bool bst_floor(const struct bst* bst, const int64_t data, int64_t* floor)
+{
+    return floor_key(bst, data, true, floor);
+}
+
+bool bst_successor(const struct bst* bst, const int64_t data, int64_t* successor)
+{
+    return ceiling_key(bst, data, false, successor);
+}
+
+bool bst_predecessor(const struct bst* bst, const int64_t data, int64_t* predecessor)
+{
+    return floor_key(bst, data, false, predecessor);
+}
+
+int64_t bst_range_sum(const struct bst* bst, const int64_t from, const int64_t to)
+{
+    if (bst->btree != NULL)
+    {
+        return btree_sum_range(bst->btree, from, to);
+    }
+    if (bst->compare != NULL)
+    {
+        fprintf(stderr, "bst_range_sum: not supported with a comparator\n");
+        return 0;
+    }
+    if (bst_compare(bst, from, to) > 0)
+    {
+        return 0;
+    }
+    return (int64_t)((uint64_t)sum_less(bst, to, true) - (uint64_t)sum_less(bst, from, false));
+}
+
+int64_t bst_range_min(const struct bst* bst, const int64_t from, const int64_t to)
+{
+    int64_t min;
+    if (bst_ceiling(bst, from, &min) && bst_compare(bst, min, to) <= 0)
+    {
+        return min;
+    }
+    fprintf(stderr, "bst_range_min: range is empty\n");
+    return 0;
+}
+
+int64_t bst_range_max(const struct bst* bst, const int64_t from, const int64_t to)
+{
+    int64_t max;
+    if (bst_floor(bst, to, &max) && bst_compare(bst, max, from) >= 0)
+    {
+        return max;
+    }
+    fprintf(stderr, "bst_range_max: range is empty\n");
+    return 0;
+}
+
+struct print_frame
+{
+    const struct node* node;
+    uint64_t prefix_length;
+    bool is_left;
+};
+
 void bst_print_int(const struct bst* bst)
 {
-    print_int_recursive(bst, bst->root, "", false);
+    if (bst->btree != NULL)
+    {
+        btree_print_int(bst->btree);
+        return;
+    }
+    uint64_t capacity = node_get_size(bst->root) + 2;
+    struct print_frame* frames = malloc(capacity * sizeof(struct print_frame));
+    char* prefix = malloc(capacity * strlen("│  ") + 1);
+    if (!frames || !prefix)
+    {
+        fprintf(stderr, "bst_print_int: stack malloc failed\n");
+        free(frames);
+        free(prefix);
+        return;
+    }
+
+    uint64_t count = 0;
+    frames[count++] = (struct print_frame){bst->root, 0, false};
+    while (count > 0)
+    {
+        struct print_frame frame = frames[--count];
+        prefix[frame.prefix_length] = '\0';
+        printf("\n%s", prefix);
+        uint64_t next_length = frame.prefix_length;
+        if (frame.node != bst->root)
+        {
+            printf("%s", frame.is_left ? "├──" : "└──");
+            strcpy(prefix + next_length, frame.is_left ? "│  " : "   ");
+            next_length += strlen(prefix + next_length);
+        }
+        if (frame.node == NULL)
+        {
+            printf("()");
+            continue;
+        }
+        printf("%lld", frame.node->data);
+        frames[count++] = (struct print_frame){frame.node->right, next_length, false};
+        frames[count++] = (struct print_frame){frame.node->left, next_length, true};
+    }
+    free(frames);
+    free(prefix);
 }
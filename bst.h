@@ -3,15 +3,28 @@
 
 #include <stdlib.h>
 #include <stdint.h>
+#include <stdatomic.h>
 #include "list.h"
+#include "btree.h"
+#include "list-search.h"
 
-#define bst(T) bst_create(false);
-#define avl(T) bst_create(true);
+#define BST_IS_STRING(T) _Generic((T){0}, char*: true, const char*: true, default: false)
+#define bst(T) bst_create_typed(false, BST_IS_STRING(T))
+#define avl(T) bst_create_typed(true, BST_IS_STRING(T))
+#define btree(T) bst_create_btree()
 
 struct bst
 {
     bool is_avl;
+    bool is_persistent;
     struct node* root;
+    struct btree* btree;
+    struct list* frozen;
+    int (*compare)(const int64_t, const int64_t);
+    struct node_slab* slabs;
+    struct node* free_nodes;
+    uint64_t slab_count;
+    uint64_t slab_size;
 };
 
 struct node
@@ -19,22 +32,81 @@ struct node
     struct node* left;
     struct node* right;
     int64_t data;
+    void* value;
+    int64_t sum;
+    uint64_t size;
     int16_t height;
+    atomic_uint refs;
+};
+
+struct bst_cursor
+{
+    const struct bst* bst;
+    struct list* stack;
+    struct btree_leaf* leaf;
+    uint16_t leaf_index;
+};
+
+struct node_slab
+{
+    struct node_slab* next;
+    struct node nodes[];
 };
 
 
 struct bst* bst_create(const bool is_avl);
+struct bst* bst_create_typed(const bool is_avl, const bool string_type);
+struct bst* bst_create_with_comparator(const bool is_avl, int (*compare)(const int64_t, const int64_t));
+struct bst* bst_create_btree(void);
+struct bst* bst_create_from_sorted(const int64_t* data, const uint64_t count, const bool is_avl);
+struct bst* bst_create_persistent(const bool is_avl);
+// Not thread-safe against writers of the same tree: a mutator copies only
+// nodes shared with a snapshot and updates the rest in place, so calls to
+// bst_snapshot and to any mutator on one tree must be serialised by the
+// caller. Once taken, a snapshot and its source may be used from different
+// threads, as each holds its own references to the shared nodes.
+struct bst* bst_snapshot(const struct bst* bst);
 void bst_destroy(struct bst* bst);
 
 void bst_insert(struct bst* bst, int64_t data);
 void bst_remove(struct bst* bst, int64_t data);
+void bst_put(struct bst* bst, const int64_t key, void* value);
+void bst_bulk_insert(struct bst* bst, const int64_t* data, const uint64_t count);
+
+bool bst_freeze(struct bst* bst);
+void bst_unfreeze(struct bst* bst);
+bool bst_is_frozen(const struct bst* bst);
 
 int64_t bst_get(const struct bst* bst, int64_t data);
 bool bst_contains(const struct bst* bst, int64_t data);
 int64_t bst_get_min(const struct bst* bst);
+void* bst_get_value(const struct bst* bst, const int64_t key);
+
+bool bst_floor(const struct bst* bst, const int64_t data, int64_t* floor);
+bool bst_ceiling(const struct bst* bst, const int64_t data, int64_t* ceiling);
+bool bst_predecessor(const struct bst* bst, const int64_t data, int64_t* predecessor);
+bool bst_successor(const struct bst* bst, const int64_t data, int64_t* successor);
 
 struct list* bst_get_range(const struct bst* bst, const int64_t from, const int64_t to);
+struct list* bst_get_range_limit(const struct bst* bst, const int64_t from, const int64_t to, const uint64_t limit);
+uint64_t bst_count_range(const struct bst* bst, const int64_t from, const int64_t to);
+uint64_t bst_rank(const struct bst* bst, const int64_t data);
+int64_t bst_select(const struct bst* bst, const uint64_t index);
+
+struct bst_cursor* bst_cursor_create(const struct bst* bst);
+void bst_cursor_destroy(struct bst_cursor* cursor);
+bool bst_cursor_seek(struct bst_cursor* cursor, const int64_t from);
+bool bst_cursor_seek_first(struct bst_cursor* cursor);
+bool bst_cursor_next(struct bst_cursor* cursor);
+bool bst_cursor_prev(struct bst_cursor* cursor);
+bool bst_cursor_is_valid(const struct bst_cursor* cursor);
+int64_t bst_cursor_get(const struct bst_cursor* cursor);
+void* bst_cursor_get_value(const struct bst_cursor* cursor);
+void bst_for_each_range(const struct bst* bst, const int64_t from, const int64_t to, bool (*callback)(const int64_t data, void* context), void* context);
 int64_t bst_get_diameter(const struct bst* bst);
+int64_t bst_range_sum(const struct bst* bst, const int64_t from, const int64_t to);
+int64_t bst_range_min(const struct bst* bst, const int64_t from, const int64_t to);
+int64_t bst_range_max(const struct bst* bst, const int64_t from, const int64_t to);
 
 void bst_print_int(const struct bst* bst);
 
@@ -0,0 +1,667 @@
+#include "btree.h"
+#include "simd.h"
+
+#define BTREE_MIN_COUNT (BTREE_NODE_SIZE / 2)
+
+
+static struct btree_node* btree_leaf_create(void)
+{
+    struct btree_leaf* leaf = malloc(sizeof(struct btree_leaf));
+    if (!leaf)
+    {
+        fprintf(stderr, "btree_leaf_create: leaf malloc failed\n");
+        return NULL;
+    }
+    leaf->node.is_leaf = true;
+    leaf->node.count = 0;
+    leaf->next = NULL;
+    return &leaf->node;
+}
+
+static struct btree_node* btree_internal_create(void)
+{
+    struct btree_internal* internal = malloc(sizeof(struct btree_internal));
+    if (!internal)
+    {
+        fprintf(stderr, "btree_internal_create: internal malloc failed\n");
+        return NULL;
+    }
+    internal->node.is_leaf = false;
+    internal->node.count = 0;
+    return &internal->node;
+}
+
+static struct btree_leaf* btree_as_leaf(struct btree_node* node)
+{
+    return (struct btree_leaf*)node;
+}
+
+static struct btree_internal* btree_as_internal(struct btree_node* node)
+{
+    return (struct btree_internal*)node;
+}
+
+static uint64_t btree_subtree_count(const struct btree_node* node)
+{
+    if (node->is_leaf)
+    {
+        return node->count;
+    }
+    const struct btree_internal* internal = (const struct btree_internal*)node;
+    uint64_t count = 0;
+    for (uint16_t i = 0; i <= node->count; i++)
+    {
+        count += internal->counts[i];
+    }
+    return count;
+}
+
+static uint64_t btree_subtree_sum(const struct btree_node* node)
+{
+    if (node->is_leaf)
+    {
+        return (uint64_t)simd_sum_int64(node->keys, node->count);
+    }
+    const struct btree_internal* internal = (const struct btree_internal*)node;
+    uint64_t sum = 0;
+    for (uint16_t i = 0; i <= node->count; i++)
+    {
+        sum += internal->sums[i];
+    }
+    return sum;
+}
+
+static void btree_recount(struct btree_node* node)
+{
+    if (node->is_leaf)
+    {
+        return;
+    }
+    struct btree_internal* internal = btree_as_internal(node);
+    for (uint16_t i = 0; i <= node->count; i++)
+    {
+        internal->counts[i] = btree_subtree_count(internal->children[i]);
+        internal->sums[i] = btree_subtree_sum(internal->children[i]);
+    }
+}
+
+static void btree_node_destroy_recursive(struct btree_node* node)
+{
+    if (!node->is_leaf)
+    {
+        struct btree_internal* internal = btree_as_internal(node);
+        for (uint16_t i = 0; i <= node->count; i++)
+        {
+            btree_node_destroy_recursive(internal->children[i]);
+        }
+    }
+    free(node);
+}
+
+struct btree* btree_create(void)
+{
+    struct btree* btree = calloc(1, sizeof(struct btree));
+    if (!btree)
+    {
+        fprintf(stderr, "btree_create: btree malloc failed\n");
+        return NULL;
+    }
+    return btree;
+}
+
+void btree_destroy(struct btree* btree)
+{
+    if (btree->root != NULL)
+    {
+        btree_node_destroy_recursive(btree->root);
+    }
+    free(btree);
+}
+
+
+static uint16_t btree_child_index(const struct btree_node* node, const int64_t key)
+{
+    uint16_t index = simd_count_less_int64(node->keys, node->count, key);
+    return index + (index < node->count && node->keys[index] == key);
+}
+
+static struct btree_leaf* btree_find_leaf(const struct btree* btree, const int64_t key)
+{
+    struct btree_node* node = btree->root;
+    while (!node->is_leaf)
+    {
+        node = btree_as_internal(node)->children[btree_child_index(node, key)];
+    }
+    return btree_as_leaf(node);
+}
+
+static void btree_insert_at(struct btree_node* node, const uint16_t index, const int64_t key, struct btree_node* child)
+{
+    memmove(node->keys + index + 1, node->keys + index, (node->count - index) * sizeof(int64_t));
+    node->keys[index] = key;
+    if (!node->is_leaf)
+    {
+        struct btree_internal* internal = btree_as_internal(node);
+        memmove(internal->children + index + 2, internal->children + index + 1, (node->count - index) * sizeof(struct btree_node*));
+        internal->children[index + 1] = child;
+    }
+    node->count++;
+}
+
+static void btree_remove_at(struct btree_node* node, const uint16_t index)
+{
+    memmove(node->keys + index, node->keys + index + 1, (node->count - index - 1) * sizeof(int64_t));
+    if (!node->is_leaf)
+    {
+        struct btree_internal* internal = btree_as_internal(node);
+        memmove(internal->children + index + 1, internal->children + index + 2, (node->count - index - 1) * sizeof(struct btree_node*));
+    }
+    node->count--;
+}
+
+static void btree_split_leaf(struct btree_node* node, const uint16_t index, const int64_t key, int64_t* separator, struct btree_node* right)
+{
+    uint16_t half = BTREE_NODE_SIZE / 2;
+    memcpy(right->keys, node->keys + half, (node->count - half) * sizeof(int64_t));
+    right->count = node->count - half;
+    node->count = half;
+    btree_as_leaf(right)->next = btree_as_leaf(node)->next;
+    btree_as_leaf(node)->next = btree_as_leaf(right);
+
+    if (index < half)
+    {
+        btree_insert_at(node, index, key, NULL);
+    }
+    else
+    {
+        btree_insert_at(right, index - half, key, NULL);
+    }
+    *separator = right->keys[0];
+}
+
+static void btree_split_internal(struct btree_node* node, const uint16_t index, int64_t* separator, struct btree_node* child, struct btree_node* right)
+{
+    int64_t keys[BTREE_NODE_SIZE + 1];
+    struct btree_node* children[BTREE_NODE_SIZE + 2];
+    struct btree_internal* internal = btree_as_internal(node);
+    memcpy(keys, node->keys, index * sizeof(int64_t));
+    keys[index] = *separator;
+    memcpy(keys + index + 1, node->keys + index, (node->count - index) * sizeof(int64_t));
+    memcpy(children, internal->children, (index + 1) * sizeof(struct btree_node*));
+    children[index + 1] = child;
+    memcpy(children + index + 2, internal->children + index + 1, (node->count - index) * sizeof(struct btree_node*));
+
+    uint16_t half = (BTREE_NODE_SIZE + 1) / 2;
+    memcpy(node->keys, keys, half * sizeof(int64_t));
+    memcpy(internal->children, children, (half + 1) * sizeof(struct btree_node*));
+    node->count = half;
+    *separator = keys[half];
+    right->count = BTREE_NODE_SIZE - half;
+    memcpy(right->keys, keys + half + 1, right->count * sizeof(int64_t));
+    memcpy(btree_as_internal(right)->children, children + half + 1, (right->count + 1) * sizeof(struct btree_node*));
+}
+
+bool btree_insert(struct btree* btree, const int64_t key)
+{
+    if (btree->root == NULL)
+    {
+        btree->root = btree_leaf_create();
+        if (!btree->root)
+        {
+            return false;
+        }
+        btree->height = 1;
+    }
+
+    struct btree_node* path[BTREE_MAX_HEIGHT];
+    uint16_t path_index[BTREE_MAX_HEIGHT];
+    uint16_t depth = 0;
+    struct btree_node* node = btree->root;
+    while (!node->is_leaf)
+    {
+        path[depth] = node;
+        path_index[depth] = btree_child_index(node, key);
+        node = btree_as_internal(node)->children[path_index[depth++]];
+    }
+
+    uint16_t index = simd_count_less_int64(node->keys, node->count, key);
+    if (index < node->count && node->keys[index] == key)
+    {
+        return false;
+    }
+
+    struct btree_node* spare[BTREE_MAX_HEIGHT + 1];
+    uint16_t spare_count = 0;
+    if (node->count == BTREE_NODE_SIZE)
+    {
+        uint16_t split_depth = depth;
+        while (split_depth > 0 && path[split_depth - 1]->count == BTREE_NODE_SIZE)
+        {
+            split_depth--;
+        }
+        uint16_t needed = 1 + (depth - split_depth) + (split_depth == 0);
+        for (; spare_count < needed; spare_count++)
+        {
+            spare[spare_count] = spare_count == 0 ? btree_leaf_create() : btree_internal_create();
+            if (!spare[spare_count])
+            {
+                while (spare_count > 0)
+                {
+                    free(spare[--spare_count]);
+                }
+                return false;
+            }
+        }
+    }
+
+    for (uint16_t i = 0; i < depth; i++)
+    {
+        btree_as_internal(path[i])->counts[path_index[i]]++;
+        btree_as_internal(path[i])->sums[path_index[i]] += (uint64_t)key;
+    }
+    btree->count++;
+    if (spare_count == 0)
+    {
+        btree_insert_at(node, index, key, NULL);
+        return true;
+    }
+
+    int64_t separator;
+    uint16_t spare_index = 0;
+    struct btree_node* child = spare[spare_index++];
+    btree_split_leaf(node, index, key, &separator, child);
+    while (depth > 0)
+    {
+        node = path[--depth];
+        index = path_index[depth];
+        if (node->count < BTREE_NODE_SIZE)
+        {
+            btree_insert_at(node, index, separator, child);
+            btree_recount(node);
+            return true;
+        }
+        btree_split_internal(node, index, &separator, child, spare[spare_index]);
+        child = spare[spare_index++];
+        btree_recount(node);
+        btree_recount(child);
+    }
+
+    struct btree_node* root = spare[spare_index];
+    root->keys[0] = separator;
+    root->count = 1;
+    btree_as_internal(root)->children[0] = btree->root;
+    btree_as_internal(root)->children[1] = child;
+    btree_recount(root);
+    btree->root = root;
+    btree->height++;
+    return true;
+}
+
+static void btree_borrow_left(struct btree_node* parent, const uint16_t index, struct btree_node* node, struct btree_node* left)
+{
+    if (node->is_leaf)
+    {
+        btree_insert_at(node, 0, left->keys[left->count - 1], NULL);
+        left->count--;
+        parent->keys[index - 1] = node->keys[0];
+        return;
+    }
+    struct btree_internal* internal = btree_as_internal(node);
+    struct btree_internal* left_internal = btree_as_internal(left);
+    memmove(node->keys + 1, node->keys, node->count * sizeof(int64_t));
+    memmove(internal->children + 1, internal->children, (node->count + 1) * sizeof(struct btree_node*));
+    node->keys[0] = parent->keys[index - 1];
+    internal->children[0] = left_internal->children[left->count];
+    node->count++;
+    parent->keys[index - 1] = left->keys[left->count - 1];
+    left->count--;
+}
+
+static void btree_borrow_right(struct btree_node* parent, const uint16_t index, struct btree_node* node, struct btree_node* right)
+{
+    if (node->is_leaf)
+    {
+        node->keys[node->count++] = right->keys[0];
+        memmove(right->keys, right->keys + 1, (right->count - 1) * sizeof(int64_t));
+        right->count--;
+        parent->keys[index] = right->keys[0];
+        return;
+    }
+    struct btree_internal* internal = btree_as_internal(node);
+    struct btree_internal* right_internal = btree_as_internal(right);
+    node->keys[node->count] = parent->keys[index];
+    internal->children[node->count + 1] = right_internal->children[0];
+    node->count++;
+    parent->keys[index] = right->keys[0];
+    memmove(right->keys, right->keys + 1, (right->count - 1) * sizeof(int64_t));
+    memmove(right_internal->children, right_internal->children + 1, right->count * sizeof(struct btree_node*));
+    right->count--;
+}
+
+static void btree_merge(struct btree_node* parent, const uint16_t index, struct btree_node* left, struct btree_node* right)
+{
+    if (left->is_leaf)
+    {
+        memcpy(left->keys + left->count, right->keys, right->count * sizeof(int64_t));
+        left->count += right->count;
+        btree_as_leaf(left)->next = btree_as_leaf(right)->next;
+    }
+    else
+    {
+        left->keys[left->count] = parent->keys[index];
+        memcpy(left->keys + left->count + 1, right->keys, right->count * sizeof(int64_t));
+        memcpy(btree_as_internal(left)->children + left->count + 1, btree_as_internal(right)->children, (right->count + 1) * sizeof(struct btree_node*));
+        left->count += 1 + right->count;
+    }
+    btree_remove_at(parent, index);
+    free(right);
+}
+
+bool btree_remove(struct btree* btree, const int64_t key)
+{
+    if (btree->root == NULL)
+    {
+        return false;
+    }
+
+    struct btree_node* path[BTREE_MAX_HEIGHT];
+    uint16_t path_index[BTREE_MAX_HEIGHT];
+    uint16_t depth = 0;
+    struct btree_node* node = btree->root;
+    while (!node->is_leaf)
+    {
+        path[depth] = node;
+        path_index[depth] = btree_child_index(node, key);
+        node = btree_as_internal(node)->children[path_index[depth++]];
+    }
+
+    uint16_t index = simd_count_less_int64(node->keys, node->count, key);
+    if (index == node->count || node->keys[index] != key)
+    {
+        return false;
+    }
+    btree_remove_at(node, index);
+    btree->count--;
+    for (uint16_t i = 0; i < depth; i++)
+    {
+        btree_as_internal(path[i])->counts[path_index[i]]--;
+        btree_as_internal(path[i])->sums[path_index[i]] -= (uint64_t)key;
+    }
+
+    while (depth > 0 && node->count < BTREE_MIN_COUNT)
+    {
+        struct btree_node* parent = path[--depth];
+        struct btree_node** children = btree_as_internal(parent)->children;
+        index = path_index[depth];
+        struct btree_node* left = index > 0 ? children[index - 1] : NULL;
+        struct btree_node* right = index < parent->count ? children[index + 1] : NULL;
+        struct btree_node* merged = node;
+        if (left != NULL && left->count > BTREE_MIN_COUNT)
+        {
+            btree_borrow_left(parent, index, node, left);
+            btree_recount(left);
+        }
+        else if (right != NULL && right->count > BTREE_MIN_COUNT)
+        {
+            btree_borrow_right(parent, index, node, right);
+            btree_recount(right);
+        }
+        else if (left != NULL)
+        {
+            btree_merge(parent, index - 1, left, node);
+            merged = left;
+        }
+        else
+        {
+            btree_merge(parent, index, node, right);
+        }
+        btree_recount(merged);
+        btree_recount(parent);
+        node = parent;
+    }
+
+    if (btree->root->count == 0)
+    {
+        struct btree_node* root = btree->root;
+        btree->root = root->is_leaf ? NULL : btree_as_internal(root)->children[0];
+        btree->height--;
+        free(root);
+    }
+    return true;
+}
+
+bool btree_contains(const struct btree* btree, const int64_t key)
+{
+    if (btree->root == NULL)
+    {
+        return false;
+    }
+    struct btree_leaf* leaf = btree_find_leaf(btree, key);
+    uint16_t index = simd_count_less_int64(leaf->node.keys, leaf->node.count, key);
+    return index < leaf->node.count && leaf->node.keys[index] == key;
+}
+
+int64_t btree_get_min(const struct btree* btree)
+{
+    if (btree->root == NULL)
+    {
+        fprintf(stderr, "btree_get_min: tree is empty\n");
+        return 0;
+    }
+    struct btree_node* node = btree->root;
+    while (!node->is_leaf)
+    {
+        node = btree_as_internal(node)->children[0];
+    }
+    return node->keys[0];
+}
+
+void btree_get_range(const struct btree* btree, const int64_t from, const int64_t to, const uint64_t limit, struct list* list)
+{
+    if (btree->root == NULL || from > to)
+    {
+        return;
+    }
+    struct btree_leaf* leaf = btree_find_leaf(btree, from);
+    uint16_t index = simd_count_less_int64(leaf->node.keys, leaf->node.count, from);
+    while (leaf != NULL)
+    {
+        for (; index < leaf->node.count; index++)
+        {
+            if (leaf->node.keys[index] > to || list->count >= limit)
+            {
+                return;
+            }
+            list_append(list, (void*)leaf->node.keys[index]);
+        }
+        leaf = leaf->next;
+        index = 0;
+    }
+}
+
+static uint64_t btree_count_less(const struct btree* btree, const int64_t key, const bool is_inclusive)
+{
+    if (btree->root == NULL)
+    {
+        return 0;
+    }
+    uint64_t count = 0;
+    const struct btree_node* node = btree->root;
+    while (!node->is_leaf)
+    {
+        const struct btree_internal* internal = (const struct btree_internal*)node;
+        uint16_t index = btree_child_index(node, key);
+        for (uint16_t i = 0; i < index; i++)
+        {
+            count += internal->counts[i];
+        }
+        node = internal->children[index];
+    }
+    uint16_t index = simd_count_less_int64(node->keys, node->count, key);
+    return count + index + (is_inclusive && index < node->count && node->keys[index] == key);
+}
+
+uint64_t btree_count_range(const struct btree* btree, const int64_t from, const int64_t to)
+{
+    if (from > to)
+    {
+        return 0;
+    }
+    return btree_count_less(btree, to, true) - btree_count_less(btree, from, false);
+}
+
+uint64_t btree_rank(const struct btree* btree, const int64_t key)
+{
+    return btree_count_less(btree, key, false);
+}
+
+bool btree_select(const struct btree* btree, const uint64_t index, int64_t* key)
+{
+    if (index >= btree->count)
+    {
+        return false;
+    }
+    uint64_t rank = index;
+    const struct btree_node* node = btree->root;
+    while (!node->is_leaf)
+    {
+        const struct btree_internal* internal = (const struct btree_internal*)node;
+        uint16_t child = 0;
+        while (rank >= internal->counts[child])
+        {
+            rank -= internal->counts[child++];
+        }
+        node = internal->children[child];
+    }
+    *key = node->keys[rank];
+    return true;
+}
+
+
+static uint64_t btree_sum_less(const struct btree* btree, const int64_t key, const bool is_inclusive)
+{
+    if (btree->root == NULL)
+    {
+        return 0;
+    }
+    uint64_t sum = 0;
+    const struct btree_node* node = btree->root;
+    while (!node->is_leaf)
+    {
+        const struct btree_internal* internal = (const struct btree_internal*)node;
+        uint16_t index = btree_child_index(node, key);
+        for (uint16_t i = 0; i < index; i++)
+        {
+            sum += internal->sums[i];
+        }
+        node = internal->children[index];
+    }
+    uint16_t index = simd_count_less_int64(node->keys, node->count, key);
+    index += is_inclusive && index < node->count && node->keys[index] == key;
+    return sum + (uint64_t)simd_sum_int64(node->keys, index);
+}
+
+int64_t btree_sum_range(const struct btree* btree, const int64_t from, const int64_t to)
+{
+    if (from > to)
+    {
+        return 0;
+    }
+    return (int64_t)(btree_sum_less(btree, to, true) - btree_sum_less(btree, from, false));
+}
+
+struct btree_leaf* btree_seek(const struct btree* btree, const int64_t key, uint16_t* index)
+{
+    if (btree->root == NULL)
+    {
+        return NULL;
+    }
+    struct btree_leaf* leaf = btree_find_leaf(btree, key);
+    *index = simd_count_less_int64(leaf->node.keys, leaf->node.count, key);
+    if (*index == leaf->node.count)
+    {
+        leaf = leaf->next;
+        *index = 0;
+    }
+    return leaf;
+}
+
+struct btree_leaf* btree_prev_leaf(const struct btree* btree, const struct btree_leaf* leaf)
+{
+    int64_t key = leaf->node.keys[0];
+    struct btree_node* node = btree->root;
+    struct btree_node* prev = NULL;
+    while (!node->is_leaf)
+    {
+        uint16_t index = btree_child_index(node, key);
+        prev = index > 0 ? btree_as_internal(node)->children[index - 1] : prev;
+        node = btree_as_internal(node)->children[index];
+    }
+    if (prev == NULL)
+    {
+        return NULL;
+    }
+    while (!prev->is_leaf)
+    {
+        prev = btree_as_internal(prev)->children[prev->count];
+    }
+    return btree_as_leaf(prev);
+}
+
+
+bool btree_floor(const struct btree* btree, const int64_t key, int64_t* floor)
+{
+    if (btree->root == NULL)
+    {
+        return false;
+    }
+    struct btree_node* node = btree->root;
+    struct btree_node* prev = NULL;
+    while (!node->is_leaf)
+    {
+        uint16_t index = btree_child_index(node, key);
+        prev = index > 0 ? btree_as_internal(node)->children[index - 1] : prev;
+        node = btree_as_internal(node)->children[index];
+    }
+    uint16_t index = btree_child_index(node, key);
+    if (index == 0)
+    {
+        if (prev == NULL)
+        {
+            return false;
+        }
+        while (!prev->is_leaf)
+        {
+            prev = btree_as_internal(prev)->children[prev->count];
+        }
+        node = prev;
+        index = prev->count;
+    }
+    *floor = node->keys[index - 1];
+    return true;
+}
+
+static void btree_print_int_recursive(const struct btree_node* node, const uint16_t depth)
+{
+    printf("\n%*s", depth * 4, "");
+    for (uint16_t i = 0; i < node->count; i++)
+    {
+        printf(i == 0 ? "%lld" : " %lld", node->keys[i]);
+    }
+    if (!node->is_leaf)
+    {
+        const struct btree_internal* internal = (const struct btree_internal*)node;
+        for (uint16_t i = 0; i <= node->count; i++)
+        {
+            btree_print_int_recursive(internal->children[i], depth + 1);
+        }
+    }
+}
+
+void btree_print_int(const struct btree* btree)
+{
+    if (btree->root != NULL)
+    {
+        btree_print_int_recursive(btree->root, 0);
+    }
+}
@@ -0,0 +1,60 @@
+#ifndef BTREE_H
+#define BTREE_H
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include "list.h"
+
+#define BTREE_NODE_SIZE 64
+#define BTREE_MAX_HEIGHT 16
+
+struct btree_node
+{
+    bool is_leaf;
+    uint16_t count;
+    int64_t keys[BTREE_NODE_SIZE];
+};
+
+struct btree_leaf
+{
+    struct btree_node node;
+    struct btree_leaf* next;
+};
+
+struct btree_internal
+{
+    struct btree_node node;
+    struct btree_node* children[BTREE_NODE_SIZE + 1];
+    uint64_t counts[BTREE_NODE_SIZE + 1];
+    uint64_t sums[BTREE_NODE_SIZE + 1];
+};
+
+struct btree
+{
+    struct btree_node* root;
+    uint64_t count;
+    uint16_t height;
+};
+
+struct btree* btree_create(void);
+void btree_destroy(struct btree* btree);
+
+bool btree_insert(struct btree* btree, const int64_t key);
+bool btree_remove(struct btree* btree, const int64_t key);
+bool btree_contains(const struct btree* btree, const int64_t key);
+int64_t btree_get_min(const struct btree* btree);
+void btree_get_range(const struct btree* btree, const int64_t from, const int64_t to, const uint64_t limit, struct list* list);
+uint64_t btree_count_range(const struct btree* btree, const int64_t from, const int64_t to);
+uint64_t btree_rank(const struct btree* btree, const int64_t key);
+bool btree_select(const struct btree* btree, const uint64_t index, int64_t* key);
+int64_t btree_sum_range(const struct btree* btree, const int64_t from, const int64_t to);
+
+struct btree_leaf* btree_seek(const struct btree* btree, const int64_t key, uint16_t* index);
+struct btree_leaf* btree_prev_leaf(const struct btree* btree, const struct btree_leaf* leaf);
+bool btree_floor(const struct btree* btree, const int64_t key, int64_t* floor);
+
+void btree_print_int(const struct btree* btree);
+
+#endif
@@ -0,0 +1,282 @@
+#include "compressed-list.h"
+
+#define COMPRESSED_LIST_VARINT UINT8_MAX
+
+
+static uint8_t compressed_list_bit_width(const int64_t* data, const uint64_t count)
+{
+    if (count < COMPRESSED_LIST_BLOCK_SIZE)
+    {
+        return COMPRESSED_LIST_VARINT;
+    }
+    uint64_t max_delta = 0;
+    for (uint64_t i = 1; i < count; i++)
+    {
+        uint64_t delta = (uint64_t)data[i] - (uint64_t)data[i - 1];
+        max_delta = delta > max_delta ? delta : max_delta;
+    }
+    if (max_delta > UINT32_MAX)
+    {
+        return COMPRESSED_LIST_VARINT;
+    }
+    return max_delta == 0 ? 0 : 64 - __builtin_clzll(max_delta);
+}
+
+static uint64_t compressed_list_varint_size(const int64_t* data, const uint64_t count)
+{
+    uint64_t size = 0;
+    for (uint64_t i = 1; i < count; i++)
+    {
+        uint64_t delta = (uint64_t)data[i] - (uint64_t)data[i - 1];
+        size += delta == 0 ? 1 : (63 - __builtin_clzll(delta)) / 7 + 1;
+    }
+    return size;
+}
+
+static uint64_t compressed_list_varint_encode(const int64_t* data, const uint64_t count, uint8_t* target)
+{
+    uint64_t size = 0;
+    for (uint64_t i = 1; i < count; i++)
+    {
+        uint64_t delta = (uint64_t)data[i] - (uint64_t)data[i - 1];
+        while (delta >= 0x80)
+        {
+            target[size++] = (uint8_t)(delta | 0x80);
+            delta >>= 7;
+        }
+        target[size++] = (uint8_t)delta;
+    }
+    return size;
+}
+
+static void compressed_list_varint_decode(const uint8_t* data, const uint64_t count, const int64_t first, int64_t* target)
+{
+    uint64_t value = (uint64_t)first;
+    target[0] = first;
+    for (uint64_t i = 1; i < count; i++)
+    {
+        uint64_t delta = 0;
+        uint64_t shift = 0;
+        while (*data & 0x80)
+        {
+            delta |= (uint64_t)(*data++ & 0x7F) << shift;
+            shift += 7;
+        }
+        delta |= (uint64_t)*data++ << shift;
+        value += delta;
+        target[i] = (int64_t)value;
+    }
+}
+
+static uint64_t compressed_list_block_count(const struct compressed_list* list, const uint64_t block_index)
+{
+    uint64_t from = block_index * COMPRESSED_LIST_BLOCK_SIZE;
+    return list->count - from < COMPRESSED_LIST_BLOCK_SIZE ? list->count - from : COMPRESSED_LIST_BLOCK_SIZE;
+}
+
+static uint64_t compressed_list_lower_bound_range(const int64_t* data, const uint64_t count, const int64_t value)
+{
+    const int64_t* base = data;
+    uint64_t range_count = count;
+    while (range_count > 1)
+    {
+        uint64_t half = range_count / 2;
+        base = base[half] < value ? base + half : base;
+        range_count -= half;
+    }
+    return (base - data) + (*base < value);
+}
+
+struct compressed_list* compressed_list_create(const struct list* list)
+{
+    int64_t* data = malloc((list->count > 0 ? list->count : 1) * sizeof(int64_t));
+    if (!data)
+    {
+        fprintf(stderr, "compressed_list_create: data malloc failed\n");
+        return NULL;
+    }
+    for (uint64_t i = 0; i < list->count; i++)
+    {
+        data[i] = (int64_t)list->data[1 + i];
+    }
+    struct compressed_list* compressed = compressed_list_create_from_array(data, list->count);
+    free(data);
+    return compressed;
+}
+
+struct compressed_list* compressed_list_create_from_array(const int64_t* data, const uint64_t count)
+{
+    if (!simd_is_sorted_int64(data, count))
+    {
+        fprintf(stderr, "compressed_list_create_from_array: data is not sorted\n");
+        return NULL;
+    }
+
+    struct compressed_list* list = calloc(1, sizeof(struct compressed_list));
+    if (!list)
+    {
+        fprintf(stderr, "compressed_list_create_from_array: list malloc failed\n");
+        return NULL;
+    }
+    list->count = count;
+    list->block_count = (count + COMPRESSED_LIST_BLOCK_SIZE - 1) / COMPRESSED_LIST_BLOCK_SIZE;
+    list->blocks = malloc((list->block_count > 0 ? list->block_count : 1) * sizeof(struct compressed_block));
+    if (!list->blocks)
+    {
+        fprintf(stderr, "compressed_list_create_from_array: blocks malloc failed\n");
+        free(list);
+        return NULL;
+    }
+
+    for (uint64_t i = 0; i < list->block_count; i++)
+    {
+        const int64_t* block_data = data + i * COMPRESSED_LIST_BLOCK_SIZE;
+        uint64_t block_count = compressed_list_block_count(list, i);
+        struct compressed_block* block = &list->blocks[i];
+        block->first = block_data[0];
+        block->offset = list->data_size;
+        block->bit_width = compressed_list_bit_width(block_data, block_count);
+        list->data_size += block->bit_width == COMPRESSED_LIST_VARINT ? compressed_list_varint_size(block_data, block_count) : simd_packed_size(block->bit_width);
+    }
+
+    list->data = malloc(list->data_size > 0 ? list->data_size : 1);
+    if (!list->data)
+    {
+        fprintf(stderr, "compressed_list_create_from_array: data malloc failed\n");
+        free(list->blocks);
+        free(list);
+        return NULL;
+    }
+
+    uint32_t deltas[COMPRESSED_LIST_BLOCK_SIZE];
+    for (uint64_t i = 0; i < list->block_count; i++)
+    {
+        const int64_t* block_data = data + i * COMPRESSED_LIST_BLOCK_SIZE;
+        uint64_t block_count = compressed_list_block_count(list, i);
+        struct compressed_block* block = &list->blocks[i];
+        if (block->bit_width == COMPRESSED_LIST_VARINT)
+        {
+            compressed_list_varint_encode(block_data, block_count, list->data + block->offset);
+            continue;
+        }
+        deltas[0] = 0;
+        for (uint64_t j = 1; j < COMPRESSED_LIST_BLOCK_SIZE; j++)
+        {
+            deltas[j] = (uint32_t)((uint64_t)block_data[j] - (uint64_t)block_data[j - 1]);
+        }
+        simd_pack_block(deltas, block->bit_width, list->data + block->offset);
+    }
+
+    return list;
+}
+
+void compressed_list_destroy(struct compressed_list* list)
+{
+    free(list->blocks);
+    free(list->data);
+    free(list);
+}
+
+
+uint64_t compressed_list_decode_block(const struct compressed_list* list, const uint64_t block_index, int64_t* target)
+{
+    if (block_index >= list->block_count)
+    {
+        fprintf(stderr, "compressed_list_decode_block: block index out of bounds\n");
+        return 0;
+    }
+    const struct compressed_block* block = &list->blocks[block_index];
+    uint64_t count = compressed_list_block_count(list, block_index);
+    if (block->bit_width == COMPRESSED_LIST_VARINT)
+    {
+        compressed_list_varint_decode(list->data + block->offset, count, block->first, target);
+        return count;
+    }
+    uint32_t deltas[COMPRESSED_LIST_BLOCK_SIZE];
+    simd_unpack_block(list->data + block->offset, block->bit_width, deltas);
+    simd_prefix_sum_int64(deltas, count, block->first, target);
+    return count;
+}
+
+int64_t compressed_list_get(const struct compressed_list* list, const uint64_t index)
+{
+    if (index >= list->count)
+    {
+        fprintf(stderr, "compressed_list_get: index out of bounds\n");
+        return 0;
+    }
+    int64_t values[COMPRESSED_LIST_BLOCK_SIZE];
+    compressed_list_decode_block(list, index / COMPRESSED_LIST_BLOCK_SIZE, values);
+    return values[index % COMPRESSED_LIST_BLOCK_SIZE];
+}
+
+uint64_t compressed_list_lower_bound(const struct compressed_list* list, const int64_t value)
+{
+    uint64_t low_index = 0;
+    uint64_t high_index = list->block_count;
+    while (low_index < high_index)
+    {
+        uint64_t middle_index = low_index + (high_index - low_index) / 2;
+        if (list->blocks[middle_index].first < value)
+        {
+            low_index = middle_index + 1;
+        }
+        else
+        {
+            high_index = middle_index;
+        }
+    }
+    if (low_index == 0)
+    {
+        return 0;
+    }
+
+    uint64_t block_index = low_index - 1;
+    int64_t values[COMPRESSED_LIST_BLOCK_SIZE];
+    uint64_t count = compressed_list_decode_block(list, block_index, values);
+    return block_index * COMPRESSED_LIST_BLOCK_SIZE + compressed_list_lower_bound_range(values, count, value);
+}
+
+bool compressed_list_contains(const struct compressed_list* list, const int64_t value)
+{
+    uint64_t index = compressed_list_lower_bound(list, value);
+    return index < list->count && compressed_list_get(list, index) == value;
+}
+
+
+int64_t compressed_list_sum(const struct compressed_list* list)
+{
+    uint64_t sum = 0;
+    int64_t values[COMPRESSED_LIST_BLOCK_SIZE];
+    for (uint64_t i = 0; i < list->block_count; i++)
+    {
+        uint64_t count = compressed_list_decode_block(list, i, values);
+        sum += (uint64_t)simd_sum_int64(values, count);
+    }
+    return (int64_t)sum;
+}
+
+struct list* compressed_list_to_list(const struct compressed_list* list)
+{
+    struct list* target = list_create(list->count > 0 ? list->count : 1);
+    if (!target)
+    {
+        return NULL;
+    }
+    int64_t values[COMPRESSED_LIST_BLOCK_SIZE];
+    for (uint64_t i = 0; i < list->block_count; i++)
+    {
+        uint64_t count = compressed_list_decode_block(list, i, values);
+        for (uint64_t j = 0; j < count; j++)
+        {
+            target->data[1 + target->count + j] = (void*)values[j];
+        }
+        target->count += count;
+    }
+    return target;
+}
+
+uint64_t compressed_list_memory_size(const struct compressed_list* list)
+{
+    return sizeof(struct compressed_list) + list->block_count * sizeof(struct compressed_block) + list->data_size;
+}
@@ -0,0 +1,42 @@
+#ifndef COMPRESSED_LIST_H
+#define COMPRESSED_LIST_H
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include "list.h"
+#include "simd.h"
+
+#define COMPRESSED_LIST_BLOCK_SIZE SIMD_PACK_BLOCK_SIZE
+
+struct compressed_block
+{
+    int64_t first;
+    uint64_t offset;
+    uint8_t bit_width;
+};
+
+struct compressed_list
+{
+    uint64_t count;
+    uint64_t block_count;
+    uint64_t data_size;
+    struct compressed_block* blocks;
+    uint8_t* data;
+};
+
+struct compressed_list* compressed_list_create(const struct list* list);
+struct compressed_list* compressed_list_create_from_array(const int64_t* data, const uint64_t count);
+void compressed_list_destroy(struct compressed_list* list);
+
+int64_t compressed_list_get(const struct compressed_list* list, const uint64_t index);
+uint64_t compressed_list_decode_block(const struct compressed_list* list, const uint64_t block_index, int64_t* target);
+uint64_t compressed_list_lower_bound(const struct compressed_list* list, const int64_t value);
+bool compressed_list_contains(const struct compressed_list* list, const int64_t value);
+
+int64_t compressed_list_sum(const struct compressed_list* list);
+struct list* compressed_list_to_list(const struct compressed_list* list);
+uint64_t compressed_list_memory_size(const struct compressed_list* list);
+
+#endif
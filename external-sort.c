@@ -0,0 +1,348 @@
+#include "external-sort.h"
+#include <pthread.h>
+
+#define EXTERNAL_SORT_CHUNK_BUFFERS 3
+#define EXTERNAL_SORT_MIN_RUN_BUFFER 512
+#define EXTERNAL_SORT_MIN_COUNT (8 * EXTERNAL_SORT_MIN_RUN_BUFFER)
+#define EXTERNAL_SORT_IO_BUFFER_SIZE (1 << 20)
+
+struct external_sort_io_task
+{
+    FILE* file;
+    struct list* chunk;
+    uint64_t chunk_size;
+    bool is_failed;
+};
+
+struct external_sort_run
+{
+    FILE* file;
+    int64_t* buffer;
+    uint64_t buffer_size;
+    uint64_t count;
+    uint64_t index;
+    bool is_done;
+};
+
+
+static void* external_sort_read_chunk(void* arg)
+{
+    struct external_sort_io_task* task = arg;
+    task->chunk->count = fread(task->chunk->data + 1, sizeof(int64_t), task->chunk_size, task->file);
+    task->is_failed = ferror(task->file);
+    return NULL;
+}
+
+static void* external_sort_write_chunk(void* arg)
+{
+    struct external_sort_io_task* task = arg;
+    task->is_failed = fwrite(task->chunk->data + 1, sizeof(int64_t), task->chunk->count, task->file) != task->chunk->count || fflush(task->file) != 0;
+    return NULL;
+}
+
+static bool external_sort_start(pthread_t* thread, void* (*routine)(void*), void* task)
+{
+    if (pthread_create(thread, NULL, routine, task) == 0)
+    {
+        return true;
+    }
+    routine(task);
+    return false;
+}
+
+static bool external_sort_form_runs(FILE* input, struct list* runs, const uint64_t chunk_size)
+{
+    struct list* chunks[EXTERNAL_SORT_CHUNK_BUFFERS] = { NULL };
+    for (uint8_t i = 0; i < EXTERNAL_SORT_CHUNK_BUFFERS; i++)
+    {
+        chunks[i] = list_create(chunk_size);
+        if (!chunks[i])
+        {
+            for (uint8_t j = 0; j < i; j++)
+            {
+                list_destroy(chunks[j]);
+            }
+            return false;
+        }
+    }
+
+    struct external_sort_io_task read_task = { input, chunks[0], chunk_size, false };
+    struct external_sort_io_task write_task = { NULL, NULL, chunk_size, false };
+    pthread_t read_thread;
+    pthread_t write_thread;
+    bool is_reading = external_sort_start(&read_thread, external_sort_read_chunk, &read_task);
+    bool is_writing = false;
+    bool is_failed = false;
+
+    for (uint64_t i = 1; !is_failed; i++)
+    {
+        if (is_reading)
+        {
+            pthread_join(read_thread, NULL);
+            is_reading = false;
+        }
+        struct list* chunk = read_task.chunk;
+        if (read_task.is_failed)
+        {
+            fprintf(stderr, "external_sort_int64: read failed\n");
+            is_failed = true;
+            break;
+        }
+        if (chunk->count == 0)
+        {
+            break;
+        }
+
+        bool is_last_chunk = chunk->count < chunk_size;
+        if (!is_last_chunk)
+        {
+            read_task.chunk = chunks[i % EXTERNAL_SORT_CHUNK_BUFFERS];
+            is_reading = external_sort_start(&read_thread, external_sort_read_chunk, &read_task);
+        }
+
+        is_failed = list_sort_parallel(chunk) == NULL;
+
+        if (is_writing)
+        {
+            pthread_join(write_thread, NULL);
+            is_writing = false;
+            is_failed = is_failed || write_task.is_failed;
+        }
+        if (is_failed)
+        {
+            break;
+        }
+
+        FILE* run_file = tmpfile();
+        if (!run_file)
+        {
+            fprintf(stderr, "external_sort_int64: tmpfile failed\n");
+            is_failed = true;
+            break;
+        }
+        list_append(runs, run_file);
+        write_task.file = run_file;
+        write_task.chunk = chunk;
+        is_writing = external_sort_start(&write_thread, external_sort_write_chunk, &write_task);
+        is_failed = !is_writing && write_task.is_failed;
+
+        if (is_last_chunk)
+        {
+            break;
+        }
+    }
+
+    if (is_reading)
+    {
+        pthread_join(read_thread, NULL);
+    }
+    if (is_writing)
+    {
+        pthread_join(write_thread, NULL);
+        is_failed = is_failed || write_task.is_failed;
+    }
+    if (is_failed)
+    {
+        fprintf(stderr, "external_sort_int64: run formation failed\n");
+    }
+    for (uint8_t i = 0; i < EXTERNAL_SORT_CHUNK_BUFFERS; i++)
+    {
+        list_destroy(chunks[i]);
+    }
+    return !is_failed;
+}
+
+static bool external_sort_run_fill(struct external_sort_run* run)
+{
+    run->count = fread(run->buffer, sizeof(int64_t), run->buffer_size, run->file);
+    run->index = 0;
+    run->is_done = run->count == 0;
+    return !ferror(run->file);
+}
+
+static bool external_sort_run_less(const struct external_sort_run* runs, const uint64_t run_a, const uint64_t run_b)
+{
+    if (runs[run_a].is_done || runs[run_b].is_done)
+    {
+        return !runs[run_a].is_done;
+    }
+    int64_t data_a = runs[run_a].buffer[runs[run_a].index];
+    int64_t data_b = runs[run_b].buffer[runs[run_b].index];
+    return data_a < data_b || (data_a == data_b && run_a < run_b);
+}
+
+static bool loser_tree_build(uint64_t* loser_tree, const struct external_sort_run* runs, const uint64_t run_count)
+{
+    uint64_t* winners = malloc(2 * run_count * sizeof(uint64_t));
+    if (!winners)
+    {
+        return false;
+    }
+    for (uint64_t i = 0; i < run_count; i++)
+    {
+        winners[run_count + i] = i;
+    }
+    for (uint64_t i = run_count - 1; i > 0; i--)
+    {
+        uint64_t run_a = winners[2 * i];
+        uint64_t run_b = winners[2 * i + 1];
+        bool is_a_winner = external_sort_run_less(runs, run_a, run_b);
+        winners[i] = is_a_winner ? run_a : run_b;
+        loser_tree[i] = is_a_winner ? run_b : run_a;
+    }
+    loser_tree[0] = winners[1];
+    free(winners);
+    return true;
+}
+
+static void loser_tree_replay(uint64_t* loser_tree, const struct external_sort_run* runs, const uint64_t run_count)
+{
+    uint64_t winner = loser_tree[0];
+    for (uint64_t i = (run_count + winner) / 2; i > 0; i /= 2)
+    {
+        if (external_sort_run_less(runs, loser_tree[i], winner))
+        {
+            uint64_t loser = winner;
+            winner = loser_tree[i];
+            loser_tree[i] = loser;
+        }
+    }
+    loser_tree[0] = winner;
+}
+
+static bool external_sort_merge_runs(struct list* run_files, const uint64_t first_run, const uint64_t run_count, FILE* output, const uint64_t memory_count)
+{
+    if (run_count == 0)
+    {
+        return true;
+    }
+    uint64_t buffer_size = memory_count / (run_count + 1);
+    struct external_sort_run* runs = calloc(run_count, sizeof(struct external_sort_run));
+    uint64_t* loser_tree = malloc((run_count > 1 ? run_count : 2) * sizeof(uint64_t));
+    int64_t* output_buffer = malloc(buffer_size * sizeof(int64_t));
+    bool is_failed = !runs || !loser_tree || !output_buffer;
+
+    for (uint64_t i = 0; i < run_count && !is_failed; i++)
+    {
+        runs[i].file = list_get(run_files, first_run + i);
+        runs[i].buffer_size = buffer_size;
+        runs[i].buffer = malloc(buffer_size * sizeof(int64_t));
+        rewind(runs[i].file);
+        is_failed = !runs[i].buffer || !external_sort_run_fill(&runs[i]);
+    }
+
+    if (!is_failed && run_count > 1)
+    {
+        is_failed = !loser_tree_build(loser_tree, runs, run_count);
+    }
+    else if (!is_failed)
+    {
+        loser_tree[0] = 0;
+    }
+
+    uint64_t output_count = 0;
+    while (!is_failed && !runs[loser_tree[0]].is_done)
+    {
+        struct external_sort_run* run = &runs[loser_tree[0]];
+        output_buffer[output_count++] = run->buffer[run->index++];
+        if (output_count == buffer_size)
+        {
+            is_failed = fwrite(output_buffer, sizeof(int64_t), output_count, output) != output_count;
+            output_count = 0;
+        }
+        if (run->index == run->count)
+        {
+            is_failed = is_failed || !external_sort_run_fill(run);
+        }
+        if (run_count > 1)
+        {
+            loser_tree_replay(loser_tree, runs, run_count);
+        }
+    }
+    if (!is_failed && output_count > 0)
+    {
+        is_failed = fwrite(output_buffer, sizeof(int64_t), output_count, output) != output_count;
+    }
+
+    if (is_failed)
+    {
+        fprintf(stderr, "external_sort_int64: merge failed\n");
+    }
+    for (uint64_t i = 0; runs != NULL && i < run_count; i++)
+    {
+        free(runs[i].buffer);
+    }
+    free(runs);
+    free(loser_tree);
+    free(output_buffer);
+    return !is_failed;
+}
+
+bool external_sort_int64(const char* input_path, const char* output_path, const uint64_t memory_size)
+{
+    uint64_t memory_count = memory_size / sizeof(int64_t);
+    if (memory_count < EXTERNAL_SORT_MIN_COUNT)
+    {
+        memory_count = EXTERNAL_SORT_MIN_COUNT;
+    }
+
+    FILE* input = fopen(input_path, "rb");
+    if (!input)
+    {
+        fprintf(stderr, "external_sort_int64: could not open %s\n", input_path);
+        return false;
+    }
+    setvbuf(input, NULL, _IOFBF, EXTERNAL_SORT_IO_BUFFER_SIZE);
+
+    struct list* runs = list_create(32);
+    bool is_sorted = external_sort_form_runs(input, runs, memory_count / (EXTERNAL_SORT_CHUNK_BUFFERS + 1));
+    fclose(input);
+
+    uint64_t max_run_count = memory_count / EXTERNAL_SORT_MIN_RUN_BUFFER - 1;
+    while (is_sorted && runs->count > max_run_count)
+    {
+        struct list* merged_runs = list_create(32);
+        for (uint64_t i = 0; is_sorted && i < runs->count; i += max_run_count)
+        {
+            FILE* merged_run = tmpfile();
+            if (!merged_run)
+            {
+                fprintf(stderr, "external_sort_int64: tmpfile failed\n");
+                is_sorted = false;
+                break;
+            }
+            list_append(merged_runs, merged_run);
+            uint64_t run_count = runs->count - i < max_run_count ? runs->count - i : max_run_count;
+            is_sorted = external_sort_merge_runs(runs, i, run_count, merged_run, memory_count) && fflush(merged_run) == 0;
+        }
+        for (uint64_t i = 0; i < runs->count; i++)
+        {
+            fclose(list_get(runs, i));
+        }
+        list_destroy(runs);
+        runs = merged_runs;
+    }
+
+    if (is_sorted)
+    {
+        FILE* output = fopen(output_path, "wb");
+        if (!output)
+        {
+            fprintf(stderr, "external_sort_int64: could not open %s\n", output_path);
+            is_sorted = false;
+        }
+        else
+        {
+            setvbuf(output, NULL, _IOFBF, EXTERNAL_SORT_IO_BUFFER_SIZE);
+            is_sorted = external_sort_merge_runs(runs, 0, runs->count, output, memory_count);
+            is_sorted = fclose(output) == 0 && is_sorted;
+        }
+    }
+
+    for (uint64_t i = 0; i < runs->count; i++)
+    {
+        fclose(list_get(runs, i));
+    }
+    list_destroy(runs);
+    return is_sorted;
+}
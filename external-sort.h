@@ -0,0 +1,13 @@
+#ifndef EXTERNAL_SORT_H
+#define EXTERNAL_SORT_H
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include "list.h"
+#include "list-sort.h"
+
+bool external_sort_int64(const char* input_path, const char* output_path, const uint64_t memory_size);
+
+#endif
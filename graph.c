@@ -1,9 +1,74 @@
 #include "graph.h"
 
+static struct vertex_edges* vertex_edges_create(void)
+{
+    struct vertex_edges* edges = malloc(sizeof(struct vertex_edges));
+    if (!edges)
+    {
+        fprintf(stderr, "vertex_edges_create: edges malloc failed\n");
+        return NULL;
+    }
+    edges->count = 0;
+    edges->size = GRAPH_INLINE_EDGES;
+    edges->data = edges->inline_data;
+    return edges;
+}
+
+static void vertex_edges_destroy(struct vertex_edges* edges)
+{
+    if (edges->data != edges->inline_data)
+    {
+        free(edges->data);
+    }
+    free(edges);
+}
+
+static bool vertex_edges_append(struct vertex_edges* edges, void* vertex, const uint64_t weight)
+{
+    if (edges->count == edges->size)
+    {
+        bool is_inline = edges->data == edges->inline_data;
+        struct vertex_weight* data = is_inline ? malloc(edges->size * 2 * sizeof(struct vertex_weight)) : realloc(edges->data, edges->size * 2 * sizeof(struct vertex_weight));
+        if (!data)
+        {
+            fprintf(stderr, "vertex_edges_append: edges realloc failed\n");
+            return false;
+        }
+        if (is_inline)
+        {
+            memcpy(data, edges->inline_data, edges->count * sizeof(struct vertex_weight));
+        }
+        edges->data = data;
+        edges->size *= 2;
+    }
+    edges->data[edges->count].vertex = vertex;
+    edges->data[edges->count].weight = weight;
+    edges->count++;
+    return true;
+}
+
+static bool vertex_edges_remove(struct vertex_edges* edges, const void* vertex)
+{
+    for (uint64_t i = 0; i < edges->count; i++)
+    {
+        if (edges->data[i].vertex == vertex)
+        {
+            memmove(&edges->data[i], &edges->data[i + 1], (edges->count - i - 1) * sizeof(struct vertex_weight));
+            edges->count--;
+            return true;
+        }
+    }
+    return false;
+}
 
 struct graph* graph_create(const bool is_directed)
 {
-    struct graph* graph = malloc(sizeof(struct graph));
+    struct graph* graph = calloc(1, sizeof(struct graph));
+    if (!graph)
+    {
+        fprintf(stderr, "graph_create: graph malloc failed\n");
+        return NULL;
+    }
 
     graph->is_directed = is_directed;
     graph->vertices = hashset_create(32, false);
@@ -17,13 +82,9 @@ void graph_destroy(struct graph* graph)
 {
     for (uint64_t i = 0; i < graph->num_vertices; i++)
     {
-        struct list* vertex_weights = graph_get_vertex_edges(graph, list_get(graph->vertices_list, i));
-        for (uint64_t i = 0; i < vertex_weights->count; i++)
-        {
-            free(list_get(vertex_weights, i));
-        }
-        list_destroy(vertex_weights);
+        vertex_edges_destroy(graph_get_vertex_edges(graph, list_get(graph->vertices_list, i)));
     }
+    list_destroy(graph->vertices_list);
     hashset_destroy(graph->vertices);
     hashmap_destroy(graph->edges);
     free(graph);
@@ -32,10 +93,14 @@ void graph_destroy(struct graph* graph)
 
 void graph_add_vertex(struct graph* graph, void* value)
 {
+    struct vertex_edges* edges = vertex_edges_create();
+    if (!edges)
+    {
+        return;
+    }
     hashset_put(graph->vertices, value);
     list_append(graph->vertices_list, value);
-    struct list* connections = list_create(8);
-    hashmap_put(graph->edges, value, connections);
+    hashmap_put(graph->edges, value, edges);
     graph->num_vertices++;
 }
 
@@ -50,17 +115,16 @@ void graph_add_edge(struct graph* graph, void* from, void* to)
         graph_add_vertex(graph, to);
     }
 
-    struct vertex_weight* to_weight = malloc(sizeof(struct vertex_weight));
-    to_weight->vertex = to;
-    to_weight->weight = 0;
-
-    list_append(hashmap_get(graph->edges, from), to_weight);
-    if (!graph->is_directed)
+    struct vertex_edges* from_edges = hashmap_get(graph->edges, from);
+    struct vertex_edges* to_edges = hashmap_get(graph->edges, to);
+    if (!from_edges || !to_edges || !vertex_edges_append(from_edges, to, 0))
     {
-        struct vertex_weight* from_weight = malloc(sizeof(struct vertex_weight));
-        from_weight->vertex = from;
-        from_weight->weight = 0;
-        list_append(hashmap_get(graph->edges, to), from_weight);
+        return;
+    }
+    if (!graph->is_directed && !vertex_edges_append(to_edges, from, 0))
+    {
+        vertex_edges_remove(from_edges, to);
+        return;
     }
     graph->num_edges++;
 }
@@ -68,45 +132,40 @@ void graph_add_edge(struct graph* graph, void* from, void* to)
 
 void graph_remove_vertex(struct graph* graph, void* vertex)
 {
-    struct list* vertex_weights = graph_get_vertex_edges(graph, vertex);
-    for (uint64_t i = 0; i < vertex_weights->count; i++)
+    struct vertex_edges* vertex_weights = graph_get_vertex_edges(graph, vertex);
+    while (vertex_weights->count > 0)
     {
-        struct vertex_weight* vertex_weight = list_get(vertex_weights, i);
-        graph_remove_edge(graph, vertex, vertex_weight->vertex);
+        graph_remove_edge(graph, vertex, vertex_weights->data[0].vertex);
     }
 
     for (uint64_t i = 0; i < graph->num_vertices; i++)
     {
         void* cur_vertex = list_get(graph->vertices_list, i);
-        struct list* vertex_weights = graph_get_vertex_edges(graph, cur_vertex);
-        for (uint64_t i = 0; i < vertex_weights->count; i++)
+        while (cur_vertex != vertex && graph_has_edge(graph, cur_vertex, vertex))
         {
-            struct vertex_weight* vertex_weight = list_get(vertex_weights, i);
-            if (vertex_weight->vertex == vertex)
-            {
-                graph_remove_edge(graph, cur_vertex, vertex);
-            }
+            graph_remove_edge(graph, cur_vertex, vertex);
         }
     }
 
     list_remove(graph->vertices_list, vertex);
+    vertex_edges_destroy(hashmap_remove(graph->edges, vertex));
     hashset_remove(graph->vertices, vertex);
     graph->num_vertices--;
 }
 
 void graph_remove_edge(struct graph* graph, void* from, void* to)
 {
-    struct vertex_weight* to_weight = graph_get_vertex_edge(graph, from, to);
-    list_remove(graph_get_vertex_edges(graph, from), to_weight);
-    free(to_weight);
+    if (!vertex_edges_remove(graph_get_vertex_edges(graph, from), to))
+    {
+        fprintf(stderr, "graph_remove_edge: edge does not exist.\n");
+        return;
+    }
     graph->num_edges--;
     if (graph->is_directed)
     {
         return;
     }
-    struct vertex_weight* from_weight = graph_get_vertex_edge(graph, to, from);
-    free(from_weight);
-    list_remove(graph_get_vertex_edges(graph, to), from_weight);
+    vertex_edges_remove(graph_get_vertex_edges(graph, to), from);
 }
 
 
@@ -118,10 +177,15 @@ void graph_add_weighted_edge(struct graph* graph, void* from, void* to, const in
 
 void graph_update_weight(struct graph* graph, void* from, void* to, const int64_t weight)
 {
-    struct list* from_neighbors = graph_get_vertex_edges(graph, from);
+    struct vertex_edges* from_neighbors = graph_get_vertex_edges(graph, from);
+    struct vertex_edges* to_neighbors = graph_get_vertex_edges(graph, to);
+    if (!from_neighbors || !to_neighbors)
+    {
+        return;
+    }
     for (uint64_t i = 0; i < from_neighbors->count; i++)
     {
-        struct vertex_weight* to_weight = (struct vertex_weight*)list_get(from_neighbors, i);
+        struct vertex_weight* to_weight = &from_neighbors->data[i];
         if (to_weight->vertex == to)
         {
             to_weight->weight = weight;
@@ -133,10 +197,9 @@ void graph_update_weight(struct graph* graph, void* from, void* to, const int64_
         return;
     }
 
-    struct list* to_neighbors = graph_get_vertex_edges(graph, to);
     for (uint64_t i = 0; i < to_neighbors->count; i++)
     {
-        struct vertex_weight* from_weight = (struct vertex_weight*)list_get(to_neighbors, i);
+        struct vertex_weight* from_weight = &to_neighbors->data[i];
         if (from_weight->vertex == from)
         {
             from_weight->weight = weight;
@@ -147,10 +210,10 @@ void graph_update_weight(struct graph* graph, void* from, void* to, const int64_
 
 static struct vertex_weight* get_vertex_weight(const struct graph* graph, void* from, void* to)
 {
-    struct list* vertex_weights = graph_get_vertex_edges(graph, from);
+    struct vertex_edges* vertex_weights = graph_get_vertex_edges(graph, from);
     for (uint64_t i = 0; i < vertex_weights->count; i++)
     {
-        struct vertex_weight* vertex_weight = list_get(vertex_weights, i);
+        struct vertex_weight* vertex_weight = &vertex_weights->data[i];
         if (vertex_weight->vertex == to)
         {
             return vertex_weight;
@@ -177,10 +240,10 @@ bool graph_has_edge(const struct graph* graph, void* from, void* to)
     {
         return false;
     }
-    struct list* vertex_weights = graph_get_vertex_edges(graph, from);
+    struct vertex_edges* vertex_weights = graph_get_vertex_edges(graph, from);
     for (uint64_t i = 0; i < vertex_weights->count; i++)
     {
-        struct vertex_weight* vertex_weight = list_get(vertex_weights, i);
+        struct vertex_weight* vertex_weight = &vertex_weights->data[i];
         if (vertex_weight->vertex == to)
         {
             return true;
@@ -226,11 +289,11 @@ struct list* graph_shortest_path(const struct graph* graph, void* start_vertex,
     while (to_visit->count > 0)
     {
         void* cur_vertex = queue_dequeue(to_visit);
-        struct list* cur_vertex_neighbors = graph_get_vertex_edges(graph, cur_vertex);
+        struct vertex_edges* cur_vertex_neighbors = graph_get_vertex_edges(graph, cur_vertex);
 
         for (uint64_t i = 0 ; i < cur_vertex_neighbors->count; i++)
         {
-            struct vertex_weight* neighbor_weight = list_get(cur_vertex_neighbors, i);
+            struct vertex_weight* neighbor_weight = &cur_vertex_neighbors->data[i];
             void* neighbor = neighbor_weight->vertex;
             if (!hashset_contains(visited, neighbor))
             {
@@ -296,11 +359,11 @@ struct list* graph_lightest_path(const struct graph* graph, void* start_vertex,
             break;
         }
         uint64_t cur_distance = (uint64_t)hashmap_get(distances, cur_vertex);
-        struct list* cur_vertex_neighbors = graph_get_vertex_edges(graph, cur_vertex);
+        struct vertex_edges* cur_vertex_neighbors = graph_get_vertex_edges(graph, cur_vertex);
         
         for (uint64_t i = 0; i < cur_vertex_neighbors->count; i++)
         {
-            struct vertex_weight* neighbor_weight = list_get(cur_vertex_neighbors, i);
+            struct vertex_weight* neighbor_weight = &cur_vertex_neighbors->data[i];
             void* neighbor = neighbor_weight->vertex;
             uint64_t weight = neighbor_weight->weight;
 
@@ -374,11 +437,11 @@ struct graph* graph_min_spanning_tree(const struct graph* graph)
             graph_add_weighted_edge(spanning_tree, parent, cur_vertex, weight);
         }
 
-        struct list* cur_vertex_neighbors = graph_get_vertex_edges(graph, cur_vertex);
+        struct vertex_edges* cur_vertex_neighbors = graph_get_vertex_edges(graph, cur_vertex);
 
         for (uint64_t i = 0; i < cur_vertex_neighbors->count; i++)
         {
-            struct vertex_weight* neighbor_weight = list_get(cur_vertex_neighbors, i);
+            struct vertex_weight* neighbor_weight = &cur_vertex_neighbors->data[i];
             if (neighbor_weight->vertex == start_vertex)
             {
                 continue;
@@ -407,10 +470,10 @@ struct graph* graph_spanning_tree(const struct graph* graph)
     {
         void* cur_vertex = stack_pop(to_visit);
 
-        struct list* cur_vertex_neighbors = graph_get_vertex_edges(graph, cur_vertex);
+        struct vertex_edges* cur_vertex_neighbors = graph_get_vertex_edges(graph, cur_vertex);
         for (uint64_t i = 0; i < cur_vertex_neighbors->count; i++)
         {
-            struct vertex_weight* neighbor_weight = list_get(cur_vertex_neighbors, i);
+            struct vertex_weight* neighbor_weight = &cur_vertex_neighbors->data[i];
             void* neighbor = neighbor_weight->vertex;
 
             if (!hashset_contains(visited, neighbor))
@@ -444,10 +507,10 @@ struct list* graph_all_reachable_from(const struct graph* graph, void* start_ver
         void* cur_vertex = stack_pop(to_visit);
         list_append(reachable_vertices, cur_vertex);
 
-        struct list* cur_vertex_neighbors = graph_get_vertex_edges(graph, cur_vertex);
+        struct vertex_edges* cur_vertex_neighbors = graph_get_vertex_edges(graph, cur_vertex);
         for (uint64_t i = 0; i < cur_vertex_neighbors->count; i++)
         {
-            struct vertex_weight* neighbor_weight = list_get(cur_vertex_neighbors, i);
+            struct vertex_weight* neighbor_weight = &cur_vertex_neighbors->data[i];
             void* neighbor = neighbor_weight->vertex;
             if (!hashset_contains(visited, neighbor))
             {
@@ -466,10 +529,10 @@ static void separation_vertices_recursive(const struct graph* graph, void* paren
     hashmap_put(vertex_depths, parent, (uint64_t*)cur_depth);
     hashmap_put(vertex_lows, parent, (uint64_t*)cur_depth);
 
-    struct list* parent_child_weights = graph_get_vertex_edges(graph, parent);
+    struct vertex_edges* parent_child_weights = graph_get_vertex_edges(graph, parent);
     for (uint64_t i = 0; i < parent_child_weights->count; i++)
     {
-        struct vertex_weight* child_weight = list_get(parent_child_weights, i);
+        struct vertex_weight* child_weight = &parent_child_weights->data[i];
         void* child = child_weight->vertex;
         if (hashmap_has_key(vertex_parents, child) && hashmap_get(vertex_parents, child) == parent)
         {
@@ -510,10 +573,10 @@ struct list* graph_separation_vertices(const struct graph* graph)
     hashmap_put(vertex_depths, start_vertex, (uint64_t*)0);
     hashmap_put(vertex_lows, start_vertex, (uint64_t*)0);
 
-    struct list* start_child_weights = graph_get_vertex_edges(graph, start_vertex);
+    struct vertex_edges* start_child_weights = graph_get_vertex_edges(graph, start_vertex);
     for (uint64_t i = 0; i < start_child_weights->count; i++)
     {
-        struct vertex_weight* child_weight = list_get(start_child_weights, i);
+        struct vertex_weight* child_weight = &start_child_weights->data[i];
         void* child = child_weight->vertex;
 
         if (!hashmap_has_key(vertex_depths, child))
@@ -526,7 +589,7 @@ struct list* graph_separation_vertices(const struct graph* graph)
     uint64_t unvisited_start_neighbors = 0;
     for (uint64_t i = 0; i < start_child_weights->count; i++)
     {
-        struct vertex_weight* neighbor_weight = list_get(start_child_weights, i);
+        struct vertex_weight* neighbor_weight = &start_child_weights->data[i];
         void* neighbor = neighbor_weight->vertex;
 
         if ((uint64_t)hashmap_get(vertex_depths, neighbor) == 1)
@@ -554,10 +617,10 @@ static void topological_sort_recursive(const struct graph* graph, void* cur_vert
 {
     hashset_put(visited, cur_vertex);
 
-    struct list* cur_vertex_neighbors = graph_get_vertex_edges(graph, cur_vertex);
+    struct vertex_edges* cur_vertex_neighbors = graph_get_vertex_edges(graph, cur_vertex);
     for (uint64_t i = 0; i < cur_vertex_neighbors->count; i++)
     {
-        struct vertex_weight* neighbor_weight = list_get(cur_vertex_neighbors, i);
+        struct vertex_weight* neighbor_weight = &cur_vertex_neighbors->data[i];
         void* neighbor = neighbor_weight->vertex;
 
         if (!hashset_contains(visited, neighbor))
@@ -589,10 +652,10 @@ static void strongly_connected_components_recursive(const struct graph* graph, v
 {
     hashset_put(visited, cur_vertex);
 
-    struct list* cur_vertex_neighbors = graph_get_vertex_edges(graph, cur_vertex);
+    struct vertex_edges* cur_vertex_neighbors = graph_get_vertex_edges(graph, cur_vertex);
     for (uint64_t i = 0; i < cur_vertex_neighbors->count; i++)
     {
-        struct vertex_weight* neighbor_weight = list_get(cur_vertex_neighbors, i);
+        struct vertex_weight* neighbor_weight = &cur_vertex_neighbors->data[i];
         void* neighbor = neighbor_weight->vertex;
 
         if (!hashset_contains(visited, neighbor))
@@ -642,10 +705,10 @@ bool is_cyclical_recursive(const struct graph* graph, void* cur_vertex, void* pa
     hashset_put(visited, cur_vertex);
     hashset_put(cur_recursion_stack, cur_vertex);
 
-    struct list* cur_vertex_neighbors = graph_get_vertex_edges(graph, cur_vertex);
+    struct vertex_edges* cur_vertex_neighbors = graph_get_vertex_edges(graph, cur_vertex);
     for (uint64_t i = 0; i < cur_vertex_neighbors->count; i++)
     {
-        struct vertex_weight* neighbor_weight = list_get(cur_vertex_neighbors, i);
+        struct vertex_weight* neighbor_weight = &cur_vertex_neighbors->data[i];
         void* neighbor = neighbor_weight->vertex;
 
         if (!hashset_contains(visited, neighbor) && is_cyclical_recursive(graph, neighbor, cur_vertex, visited, cur_recursion_stack))
@@ -683,17 +746,17 @@ bool graph_is_cyclical(const struct graph* graph)
 }
 
 
-struct list* graph_get_vertex_edges(const struct graph* graph, void* vertex)
+struct vertex_edges* graph_get_vertex_edges(const struct graph* graph, void* vertex)
 {
     return hashmap_get(graph->edges, vertex);
 }
 
 struct vertex_weight* graph_get_vertex_edge(const struct graph* graph, void* from, void* to)
 {
-    struct list* vertex_weights = hashmap_get(graph->edges, from);
+    struct vertex_edges* vertex_weights = hashmap_get(graph->edges, from);
     for (uint64_t i = 0; i < vertex_weights->count; i++)
     {
-        struct vertex_weight* vertex_weight = list_get(vertex_weights, i);
+        struct vertex_weight* vertex_weight = &vertex_weights->data[i];
         if (vertex_weight->vertex == to)
         {
             return vertex_weight;
@@ -710,10 +773,10 @@ struct graph* graph_get_reverse(const struct graph* graph)
     for (uint64_t i = 0; i < graph->num_vertices; i++)
     {
         void* vertex = list_get(graph->vertices_list, i);
-        struct list* vertex_neighbor_weights = graph_get_vertex_edges(graph, vertex);
+        struct vertex_edges* vertex_neighbor_weights = graph_get_vertex_edges(graph, vertex);
         for (uint64_t j = 0; j < vertex_neighbor_weights->count; j++)
         {
-            struct vertex_weight* neighbor_weight = list_get(vertex_neighbor_weights, j);
+            struct vertex_weight* neighbor_weight = &vertex_neighbor_weights->data[j];
             graph_add_weighted_edge(reversed_graph, neighbor_weight->vertex, vertex, neighbor_weight->weight);
         }
     }
@@ -731,15 +794,11 @@ struct graph* graph_reverse_direction(struct graph* graph)
 
 void graph_print_vertex_neighbors_char(const struct graph* graph, void* vertex)
 {
-    struct list* vertex_neigbor_weights = graph_get_vertex_edges(graph, vertex);
+    struct vertex_edges* vertex_neigbor_weights = graph_get_vertex_edges(graph, vertex);
     printf("(");
     for (uint64_t i = 0; i < vertex_neigbor_weights->count; i++)
     {
-        if (list_get(vertex_neigbor_weights, i) == NULL)
-        {
-            continue;
-        }
-        char neighbor_char = (char)(int64_t)((struct vertex_weight*)list_get(vertex_neigbor_weights, i))->vertex;
+        char neighbor_char = (char)(int64_t)vertex_neigbor_weights->data[i].vertex;
         printf(i == vertex_neigbor_weights->count - 1 ? "%c" : "%c, ", neighbor_char);
     }
     printf(")");
@@ -747,15 +806,11 @@ void graph_print_vertex_neighbors_char(const struct graph* graph, void* vertex)
 
 void graph_print_vertex_neighbors_int(const struct graph* graph, void* vertex)
 {
-    struct list* vertex_neigbor_weights = graph_get_vertex_edges(graph, vertex);
+    struct vertex_edges* vertex_neigbor_weights = graph_get_vertex_edges(graph, vertex);
     printf("(");
     for (uint64_t i = 0; i < vertex_neigbor_weights->count; i++)
     {
-        if (list_get(vertex_neigbor_weights, i) == NULL)
-        {
-            continue;
-        }
-        int64_t neighbor_int = (int64_t)((struct vertex_weight*)list_get(vertex_neigbor_weights, i))->vertex;
+        int64_t neighbor_int = (int64_t)vertex_neigbor_weights->data[i].vertex;
         printf(i == vertex_neigbor_weights->count - 1 ? "%lld" : "%lld, ", neighbor_int);
     }
     printf(")");
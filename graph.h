@@ -12,6 +12,8 @@
 #include "queue.h"
 #include "heap.h"
 
+#define GRAPH_INLINE_EDGES 4
+
 #define graph(T) graph_create(false)
 #define directed_graph(T) graph_create(true)
 
@@ -31,6 +33,14 @@ struct vertex_weight
     uint64_t weight;
 };
 
+struct vertex_edges
+{
+    uint64_t count;
+    uint64_t size;
+    struct vertex_weight* data;
+    struct vertex_weight inline_data[GRAPH_INLINE_EDGES];
+};
+
 
 struct graph* graph_create(const bool is_directed);
 void graph_destroy(struct graph* graph);
@@ -59,7 +69,7 @@ struct list* graph_strongly_connected_components(const struct graph* graph);
 bool graph_is_biconnected(const struct graph* graph);
 bool graph_is_cyclical(const struct graph* graph);
 
-struct list* graph_get_vertex_edges(const struct graph* graph, void* vertex);
+struct vertex_edges* graph_get_vertex_edges(const struct graph* graph, void* vertex);
 struct vertex_weight* graph_get_vertex_edge(const struct graph* graph, void* from, void* to);
 bool graph_has_edge(const struct graph* graph, void* from, void* to);
 
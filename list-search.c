@@ -0,0 +1,230 @@
+#include "list-search.h"
+#include "simd.h"
+
+#define INTERSECT_GALLOP_RATIO 32
+#define EYTZINGER_PREFETCH_DISTANCE 8
+
+
+static uint64_t lower_bound_range(void** data, const uint64_t count, const int64_t value)
+{
+    if (count == 0)
+    {
+        return 0;
+    }
+    void** base = data;
+    uint64_t range_count = count;
+    while (range_count > 1)
+    {
+        uint64_t half = range_count / 2;
+        base = (int64_t)base[half] < value ? base + half : base;
+        range_count -= half;
+    }
+    return (base - data) + ((int64_t)*base < value);
+}
+
+static uint64_t upper_bound_range(void** data, const uint64_t count, const int64_t value)
+{
+    if (count == 0)
+    {
+        return 0;
+    }
+    void** base = data;
+    uint64_t range_count = count;
+    while (range_count > 1)
+    {
+        uint64_t half = range_count / 2;
+        base = (int64_t)base[half] <= value ? base + half : base;
+        range_count -= half;
+    }
+    return (base - data) + ((int64_t)*base <= value);
+}
+
+static uint64_t gallop_search_range(void** data, const uint64_t count, const int64_t value, const uint64_t hint)
+{
+    if (hint >= count || (int64_t)data[hint] >= value)
+    {
+        uint64_t high_index = hint < count ? hint : count;
+        uint64_t step = 1;
+        while (step <= high_index && (int64_t)data[high_index - step] >= value)
+        {
+            high_index -= step;
+            step *= 2;
+        }
+        uint64_t low_index = step <= high_index ? high_index - step : 0;
+        return low_index + lower_bound_range(data + low_index, high_index - low_index, value);
+    }
+
+    uint64_t low_index = hint;
+    uint64_t step = 1;
+    while (low_index + step < count && (int64_t)data[low_index + step] < value)
+    {
+        low_index += step;
+        step *= 2;
+    }
+    uint64_t high_index = low_index + step < count ? low_index + step : count;
+    return low_index + 1 + lower_bound_range(data + low_index + 1, high_index - low_index - 1, value);
+}
+
+
+uint64_t list_lower_bound(const struct list* list, const int64_t value)
+{
+    return lower_bound_range(list->data + 1, list->count, value);
+}
+
+uint64_t list_upper_bound(const struct list* list, const int64_t value)
+{
+    return upper_bound_range(list->data + 1, list->count, value);
+}
+
+uint64_t list_gallop_search(const struct list* list, const int64_t value, const uint64_t hint)
+{
+    return gallop_search_range(list->data + 1, list->count, value, hint);
+}
+
+uint64_t list_view_lower_bound(const struct list_view view, const int64_t value)
+{
+    if (view.stride == 1 || view.count == 0)
+    {
+        return lower_bound_range(view.data, view.count, value);
+    }
+    uint64_t base_index = 0;
+    uint64_t range_count = view.count;
+    while (range_count > 1)
+    {
+        uint64_t half = range_count / 2;
+        base_index = (int64_t)view.data[(int64_t)(base_index + half) * view.stride] < value ? base_index + half : base_index;
+        range_count -= half;
+    }
+    return base_index + ((int64_t)view.data[(int64_t)base_index * view.stride] < value);
+}
+
+uint64_t list_view_upper_bound(const struct list_view view, const int64_t value)
+{
+    if (view.stride == 1 || view.count == 0)
+    {
+        return upper_bound_range(view.data, view.count, value);
+    }
+    uint64_t base_index = 0;
+    uint64_t range_count = view.count;
+    while (range_count > 1)
+    {
+        uint64_t half = range_count / 2;
+        base_index = (int64_t)view.data[(int64_t)(base_index + half) * view.stride] <= value ? base_index + half : base_index;
+        range_count -= half;
+    }
+    return base_index + ((int64_t)view.data[(int64_t)base_index * view.stride] <= value);
+}
+
+
+static uint64_t eytzinger_fill(void** eytzinger_data, void** sorted_data, const uint64_t count, const uint64_t index, uint64_t next_index)
+{
+    if (index > count)
+    {
+        return next_index;
+    }
+    next_index = eytzinger_fill(eytzinger_data, sorted_data, count, 2 * index, next_index);
+    eytzinger_data[index] = sorted_data[next_index];
+    return eytzinger_fill(eytzinger_data, sorted_data, count, 2 * index + 1, next_index + 1);
+}
+
+struct list* list_to_eytzinger(const struct list* list)
+{
+    struct list* eytzinger = list_create(list->count > 0 ? list->count : 1);
+    if (!eytzinger)
+    {
+        return NULL;
+    }
+    eytzinger_fill(eytzinger->data, list->data + 1, list->count, 1, 0);
+    eytzinger->count = list->count;
+    return eytzinger;
+}
+
+uint64_t list_eytzinger_lower_bound_slot(const struct list* eytzinger, const int64_t value)
+{
+    void** data = eytzinger->data;
+    uint64_t index = 1;
+    while (index <= eytzinger->count)
+    {
+        __builtin_prefetch(data + EYTZINGER_PREFETCH_DISTANCE * index);
+        index = 2 * index + ((int64_t)data[index] < value);
+    }
+    index >>= __builtin_ffsll(~index);
+    return index == 0 ? eytzinger->count : index - 1;
+}
+
+
+struct list* list_merge_sorted(const struct list* list_a, const struct list* list_b)
+{
+    struct list* merged = list_create(list_a->count + list_b->count > 0 ? list_a->count + list_b->count : 1);
+    if (!merged)
+    {
+        return NULL;
+    }
+    void** data_a = list_a->data + 1;
+    void** data_b = list_b->data + 1;
+    void** target = merged->data + 1;
+    uint64_t index_a = 0;
+    uint64_t index_b = 0;
+
+    while (index_a < list_a->count && index_b < list_b->count)
+    {
+        bool is_b_first = (int64_t)data_b[index_b] < (int64_t)data_a[index_a];
+        *target++ = is_b_first ? data_b[index_b] : data_a[index_a];
+        index_a += !is_b_first;
+        index_b += is_b_first;
+    }
+    memcpy(target, data_a + index_a, (list_a->count - index_a) * sizeof(void*));
+    target += list_a->count - index_a;
+    memcpy(target, data_b + index_b, (list_b->count - index_b) * sizeof(void*));
+
+    merged->count = list_a->count + list_b->count;
+    return merged;
+}
+
+struct list* list_intersect_sorted(const struct list* list_a, const struct list* list_b)
+{
+    const struct list* small_list = list_a->count <= list_b->count ? list_a : list_b;
+    const struct list* large_list = small_list == list_a ? list_b : list_a;
+    struct list* intersection = list_create(small_list->count > 0 ? small_list->count : 1);
+    if (!intersection)
+    {
+        return NULL;
+    }
+
+    if (small_list->count * INTERSECT_GALLOP_RATIO >= large_list->count)
+    {
+        intersection->count = simd_intersect_sorted(small_list->data + 1, small_list->count, large_list->data + 1, large_list->count, intersection->data + 1);
+        return intersection;
+    }
+
+    uint64_t large_index = 0;
+    for (uint64_t i = 0; i < small_list->count && large_index < large_list->count; i++)
+    {
+        int64_t value = (int64_t)small_list->data[1 + i];
+        uint64_t index = gallop_search_range(large_list->data + 1, large_list->count, value, large_index);
+        large_index = index > large_index ? index : large_index;
+        if (large_index < large_list->count && (int64_t)large_list->data[1 + large_index] == value)
+        {
+            intersection->data[1 + intersection->count++] = small_list->data[1 + i];
+            large_index++;
+        }
+    }
+    return intersection;
+}
+
+struct list* list_dedup_sorted(struct list* list)
+{
+    if (list->count <= 1)
+    {
+        return list;
+    }
+    void** data = list->data + 1;
+    uint64_t count = 1;
+    for (uint64_t i = 1; i < list->count; i++)
+    {
+        data[count] = data[i];
+        count += (int64_t)data[i] != (int64_t)data[count - 1];
+    }
+    list->count = count;
+    return list;
+}
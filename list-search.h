@@ -0,0 +1,19 @@
+#ifndef LIST_SEARCH_H
+#define LIST_SEARCH_H
+
+#include "list.h"
+
+uint64_t list_lower_bound(const struct list* list, const int64_t value);
+uint64_t list_upper_bound(const struct list* list, const int64_t value);
+uint64_t list_gallop_search(const struct list* list, const int64_t value, const uint64_t hint);
+uint64_t list_view_lower_bound(const struct list_view view, const int64_t value);
+uint64_t list_view_upper_bound(const struct list_view view, const int64_t value);
+
+struct list* list_to_eytzinger(const struct list* list);
+uint64_t list_eytzinger_lower_bound_slot(const struct list* eytzinger, const int64_t value);
+
+struct list* list_merge_sorted(const struct list* list_a, const struct list* list_b);
+struct list* list_intersect_sorted(const struct list* list_a, const struct list* list_b);
+struct list* list_dedup_sorted(struct list* list);
+
+#endif
@@ -1,4 +1,22 @@
 #include "list-sort.h"
+#include "simd.h"
+#include <math.h>
+#include <pthread.h>
+#include <stdatomic.h>
+#include <unistd.h>
+
+#define MERGE_SORT_INSERTION_THRESHOLD 16
+#define MERGE_SORT_PARALLEL_THRESHOLD 65536
+#define SAMPLE_SORT_THRESHOLD 65536
+#define SELECT_SAMPLE_THRESHOLD 600
+#define TOP_K_HEAP_RATIO 8
+#define VIEW_SORT_IN_PLACE_THRESHOLD 1024
+#define ADAPTIVE_SORT_MIN_RUN 24
+#define ADAPTIVE_SORT_MIN_GALLOP 7
+#define ADAPTIVE_SORT_MAX_RUNS 65
+#define STRING_SORT_INSERTION_THRESHOLD 32
+#define SAMPLE_SORT_OVERSAMPLING 16
+#define SAMPLE_SORT_MAX_BUCKETS 256
 
 struct list* list_sort_bubble(struct list* list)
 {
@@ -57,199 +75,1309 @@ struct list* list_sort_insertion(struct list* list)
     return list;
 }
 
+static void heap_sort_sift_down(void** data, uint64_t index, const uint64_t count)
+{
+    void* cur_data = data[index];
+    while (index * 2 + 1 < count)
+    {
+        uint64_t candidate_index = index * 2 + 1;
+        if (candidate_index + 1 < count && (int64_t)data[candidate_index + 1] > (int64_t)data[candidate_index])
+        {
+            candidate_index++;
+        }
+        if ((int64_t)data[candidate_index] <= (int64_t)cur_data)
+        {
+            break;
+        }
+        data[index] = data[candidate_index];
+        index = candidate_index;
+    }
+    data[index] = cur_data;
+}
+
+static void heap_sort_range(void** data, const uint64_t count)
+{
+    for (uint64_t i = count / 2; i > 0; i--)
+    {
+        heap_sort_sift_down(data, i - 1, count);
+    }
+    for (uint64_t i = count; i > 1; i--)
+    {
+        void* max_data = data[0];
+        data[0] = data[i - 1];
+        data[i - 1] = max_data;
+        heap_sort_sift_down(data, 0, i - 1);
+    }
+}
+
 struct list* list_sort_heap(struct list* list)
 {
-    for (uint64_t i = 1; i < list->count; i++)
+    heap_sort_range(list->data + 1, list->count);
+    return list; 
+}
+
+struct merge_sort_task
+{
+    void** source;
+    void** target;
+    uint64_t count;
+    bool into_target;
+    uint8_t depth;
+};
+
+struct merge_task
+{
+    void** data_a;
+    uint64_t count_a;
+    void** data_b;
+    uint64_t count_b;
+    void** target;
+    uint8_t depth;
+};
+
+static uint64_t sort_thread_count(void)
+{
+    long thread_count = sysconf(_SC_NPROCESSORS_ONLN);
+    return thread_count > 0 ? thread_count : 1;
+}
+
+uint8_t list_sort_thread_depth(void)
+{
+    uint64_t thread_count = sort_thread_count();
+    uint8_t depth = 0;
+    while (depth < 16 && (1ULL << depth) < thread_count)
+    {
+        depth++;
+    }
+    return depth;
+}
+
+static uint64_t merge_co_rank(void** data_a, const uint64_t count_a, void** data_b, const uint64_t count_b, const uint64_t rank)
+{
+    uint64_t low_index = rank > count_b ? rank - count_b : 0;
+    uint64_t high_index = rank < count_a ? rank : count_a;
+    while (low_index < high_index)
     {
-        uint64_t index = i;
-        uint64_t parent_index = (index - 1) / 2;
+        uint64_t index_a = low_index + (high_index - low_index) / 2;
+        uint64_t index_b = rank - index_a;
+        if (index_b > 0 && (int64_t)data_a[index_a] <= (int64_t)data_b[index_b - 1])
+        {
+            low_index = index_a + 1;
+        }
+        else
+        {
+            high_index = index_a;
+        }
+    }
+    return low_index;
+}
+
+static void merge_sequential(void** data_a, const uint64_t count_a, void** data_b, const uint64_t count_b, void** target)
+{
+    uint64_t index_a = 0;
+    uint64_t index_b = 0;
+    uint64_t index = 0;
 
-        while (index > 0 && (int64_t)list_get(list, index) > (int64_t)list_get(list, parent_index))
+    while (index_a < count_a && index_b < count_b)
+    {
+        if ((int64_t)data_a[index_a] <= (int64_t)data_b[index_b])
         {
-            list_swap(list, index, parent_index);
-            index = parent_index;
-            parent_index = (index - 1) / 2;
+            target[index++] = data_a[index_a++];
         }
+        else
+        {
+            target[index++] = data_b[index_b++];
+        }
+    }
+    memcpy(target + index, data_a + index_a, (count_a - index_a) * sizeof(void*));
+    index += count_a - index_a;
+    memcpy(target + index, data_b + index_b, (count_b - index_b) * sizeof(void*));
+}
+
+static void* merge_parallel(void* arg)
+{
+    struct merge_task* task = arg;
+    uint64_t count = task->count_a + task->count_b;
+    if (task->depth == 0 || count < MERGE_SORT_PARALLEL_THRESHOLD)
+    {
+        merge_sequential(task->data_a, task->count_a, task->data_b, task->count_b, task->target);
+        return NULL;
     }
-    for (uint64_t i = list->count - 1; i > 0; i--)
+
+    uint64_t rank = count / 2;
+    uint64_t index_a = merge_co_rank(task->data_a, task->count_a, task->data_b, task->count_b, rank);
+    uint64_t index_b = rank - index_a;
+
+    struct merge_task low_task = { task->data_a, index_a, task->data_b, index_b, task->target, task->depth - 1 };
+    struct merge_task high_task = { task->data_a + index_a, task->count_a - index_a, task->data_b + index_b, task->count_b - index_b, task->target + rank, task->depth - 1 };
+
+    pthread_t thread;
+    bool is_forked = !pthread_create(&thread, NULL, merge_parallel, &low_task);
+    if (!is_forked)
+    {
+        merge_parallel(&low_task);
+    }
+    merge_parallel(&high_task);
+    if (is_forked)
     {
-        list_swap(list, 0, i);
-        uint64_t index = 0;
+        pthread_join(thread, NULL);
+    }
+    return NULL;
+}
 
-        while (index * 2 + 1 < i)
+static void* merge_sort_recursive(void* arg)
+{
+    struct merge_sort_task* task = arg;
+    if (task->count <= SIMD_SORT_SMALL_MAX)
+    {
+        simd_sort_small(task->source, task->count);
+        if (task->into_target)
+        {
+            memcpy(task->target, task->source, task->count * sizeof(void*));
+        }
+        return NULL;
+    }
+
+    uint64_t middle_index = task->count / 2;
+    uint8_t depth = task->depth > 0 ? task->depth - 1 : 0;
+    struct merge_sort_task low_task = { task->source, task->target, middle_index, !task->into_target, depth };
+    struct merge_sort_task high_task = { task->source + middle_index, task->target + middle_index, task->count - middle_index, !task->into_target, depth };
+
+    pthread_t thread;
+    bool is_forked = task->depth > 0 && task->count >= MERGE_SORT_PARALLEL_THRESHOLD && !pthread_create(&thread, NULL, merge_sort_recursive, &low_task);
+    if (!is_forked)
+    {
+        merge_sort_recursive(&low_task);
+    }
+    merge_sort_recursive(&high_task);
+    if (is_forked)
+    {
+        pthread_join(thread, NULL);
+    }
+
+    void** merge_source = task->into_target ? task->source : task->target;
+    void** merge_target = task->into_target ? task->target : task->source;
+    struct merge_task merge_task = { merge_source, middle_index, merge_source + middle_index, task->count - middle_index, merge_target, task->depth };
+    merge_parallel(&merge_task);
+    return NULL;
+}
+
+struct list* list_sort_merge(struct list* list)
+{
+    if (list->count <= 1)
+    {
+        return list;
+    }
+    void** buffer = malloc(list->count * list->data_size);
+    if (!buffer)
+    {
+        fprintf(stderr, "list_sort_merge: buffer malloc failed\n");
+        return NULL;
+    }
+
+    struct merge_sort_task task = { list->data + 1, buffer, list->count, false, list_sort_thread_depth() };
+    merge_sort_recursive(&task);
+
+    free(buffer);
+    return list;
+}
+
+static uint64_t gallop_right(void** data, const uint64_t count, const int64_t key)
+{
+    uint64_t bound = 1;
+    while (bound <= count && (int64_t)data[bound - 1] <= key)
+    {
+        bound *= 2;
+    }
+    uint64_t low_index = bound / 2;
+    uint64_t high_index = bound - 1 < count ? bound - 1 : count;
+    while (low_index < high_index)
+    {
+        uint64_t middle_index = low_index + (high_index - low_index) / 2;
+        if ((int64_t)data[middle_index] <= key)
         {
-            uint64_t left_index = index * 2 + 1;
-            uint64_t right_index = index * 2 + 2;
-            int64_t left_data = (int64_t)list_get(list, left_index);
-            int64_t right_data = (int64_t)list_get(list, right_index);
-            
-            uint64_t candidate_index = right_index >= i || left_data >= right_data ? left_index : right_index;
-            if ((int64_t)list_get(list, index) < (int64_t)list_get(list, candidate_index))
+            low_index = middle_index + 1;
+        }
+        else
+        {
+            high_index = middle_index;
+        }
+    }
+    return low_index;
+}
+
+static uint64_t gallop_left(void** data, const uint64_t count, const int64_t key)
+{
+    uint64_t bound = 1;
+    while (bound <= count && (int64_t)data[bound - 1] < key)
+    {
+        bound *= 2;
+    }
+    uint64_t low_index = bound / 2;
+    uint64_t high_index = bound - 1 < count ? bound - 1 : count;
+    while (low_index < high_index)
+    {
+        uint64_t middle_index = low_index + (high_index - low_index) / 2;
+        if ((int64_t)data[middle_index] < key)
+        {
+            low_index = middle_index + 1;
+        }
+        else
+        {
+            high_index = middle_index;
+        }
+    }
+    return low_index;
+}
+
+static void binary_insertion_sort(void** data, const uint64_t sorted_count, const uint64_t count)
+{
+    for (uint64_t i = sorted_count; i < count; i++)
+    {
+        void* cur_data = data[i];
+        uint64_t index = gallop_right(data, i, (int64_t)cur_data);
+        memmove(data + index + 1, data + index, (i - index) * sizeof(void*));
+        data[index] = cur_data;
+    }
+}
+
+static uint64_t adaptive_find_run(void** data, const uint64_t start, const uint64_t count)
+{
+    if (start + 1 >= count)
+    {
+        return count;
+    }
+    uint64_t end = start + 2;
+    if ((int64_t)data[start + 1] < (int64_t)data[start])
+    {
+        while (end < count && (int64_t)data[end] < (int64_t)data[end - 1])
+        {
+            end++;
+        }
+        for (uint64_t left_index = start, right_index = end - 1; left_index < right_index; left_index++, right_index--)
+        {
+            void* data_buf = data[left_index];
+            data[left_index] = data[right_index];
+            data[right_index] = data_buf;
+        }
+        return end;
+    }
+    while (end < count && (int64_t)data[end] >= (int64_t)data[end - 1])
+    {
+        end++;
+    }
+    return end;
+}
+
+static uint64_t adaptive_extend_run(void** data, const uint64_t start, const uint64_t end, const uint64_t count)
+{
+    if (end - start >= ADAPTIVE_SORT_MIN_RUN || end == count)
+    {
+        return end;
+    }
+    uint64_t extended_end = start + ADAPTIVE_SORT_MIN_RUN < count ? start + ADAPTIVE_SORT_MIN_RUN : count;
+    binary_insertion_sort(data + start, end - start, extended_end - start);
+    return extended_end;
+}
+
+static uint8_t adaptive_node_power(const uint64_t count, const uint64_t start_a, const uint64_t start_b, const uint64_t end_b)
+{
+    uint64_t double_count = 2 * count;
+    uint64_t middle_a = start_a + start_b;
+    uint64_t middle_b = start_b + end_b;
+    uint8_t power = 0;
+    while (true)
+    {
+        power++;
+        if (middle_a >= double_count)
+        {
+            middle_a -= double_count;
+            middle_b -= double_count;
+        }
+        else if (middle_b >= double_count)
+        {
+            return power;
+        }
+        middle_a *= 2;
+        middle_b *= 2;
+    }
+}
+
+static void adaptive_merge(void** data, uint64_t start, const uint64_t middle, uint64_t end, void** buffer)
+{
+    start += gallop_right(data + start, middle - start, (int64_t)data[middle]);
+    if (start == middle)
+    {
+        return;
+    }
+    end = middle + gallop_left(data + middle, end - middle, (int64_t)data[middle - 1]);
+
+    memcpy(buffer, data + start, (middle - start) * sizeof(void*));
+    void** left = buffer;
+    void** left_end = buffer + (middle - start);
+    void** right = data + middle;
+    void** right_end = data + end;
+    void** target = data + start;
+
+    while (left < left_end && right < right_end)
+    {
+        uint64_t left_wins = 0;
+        uint64_t right_wins = 0;
+        while (left < left_end && right < right_end && left_wins < ADAPTIVE_SORT_MIN_GALLOP && right_wins < ADAPTIVE_SORT_MIN_GALLOP)
+        {
+            if ((int64_t)*right < (int64_t)*left)
             {
-                list_swap(list, index, candidate_index);
-                index = candidate_index;
+                *target++ = *right++;
+                right_wins++;
+                left_wins = 0;
             }
             else
             {
-                break;
+                *target++ = *left++;
+                left_wins++;
+                right_wins = 0;
             }
         }
+        if (left == left_end || right == right_end)
+        {
+            break;
+        }
+
+        if (left_wins >= ADAPTIVE_SORT_MIN_GALLOP)
+        {
+            uint64_t gallop_count = gallop_right(left, left_end - left, (int64_t)*right);
+            memcpy(target, left, gallop_count * sizeof(void*));
+            target += gallop_count;
+            left += gallop_count;
+        }
+        else
+        {
+            uint64_t gallop_count = gallop_left(right, right_end - right, (int64_t)*left);
+            memmove(target, right, gallop_count * sizeof(void*));
+            target += gallop_count;
+            right += gallop_count;
+        }
     }
-    return list; 
+    memcpy(target, left, (left_end - left) * sizeof(void*));
 }
 
-static struct list* merge_sort_merge(struct list* sublist_a, struct list* sublist_b)
+struct list* list_sort_adaptive(struct list* list)
 {
-    struct list* sorted_list = list_create(32);
-    uint64_t index_a = 0;
-    uint64_t index_b = 0;
+    uint64_t sorted_prefix = list_sorted_prefix_int(list);
+    if (sorted_prefix == list->count)
+    {
+        return list;
+    }
+
+    void** data = list->data + 1;
+    uint64_t count = list->count;
+    void** buffer = malloc(count * list->data_size);
+    if (!buffer)
+    {
+        fprintf(stderr, "list_sort_adaptive: buffer malloc failed\n");
+        return NULL;
+    }
+
+    uint64_t run_starts[ADAPTIVE_SORT_MAX_RUNS];
+    uint8_t run_powers[ADAPTIVE_SORT_MAX_RUNS];
+    uint8_t run_count = 0;
+
+    uint64_t start_a = 0;
+    uint64_t end_a = adaptive_extend_run(data, 0, sorted_prefix > 1 ? sorted_prefix : adaptive_find_run(data, 0, count), count);
+    while (end_a < count)
+    {
+        uint64_t start_b = end_a;
+        uint64_t end_b = adaptive_extend_run(data, start_b, adaptive_find_run(data, start_b, count), count);
+        uint8_t power = adaptive_node_power(count, start_a, start_b, end_b);
+
+        while (run_count > 0 && run_powers[run_count - 1] > power)
+        {
+            run_count--;
+            adaptive_merge(data, run_starts[run_count], start_a, end_a, buffer);
+            start_a = run_starts[run_count];
+        }
+        run_starts[run_count] = start_a;
+        run_powers[run_count] = power;
+        run_count++;
+
+        start_a = start_b;
+        end_a = end_b;
+    }
+    while (run_count > 0)
+    {
+        run_count--;
+        adaptive_merge(data, run_starts[run_count], start_a, count, buffer);
+        start_a = run_starts[run_count];
+    }
+
+    free(buffer);
+    return list;
+}
+
+static uint64_t quick_sort_partition(void** data, const uint64_t count)
+{
+    uint64_t middle_index = count / 2;
+    if ((int64_t)data[middle_index] < (int64_t)data[0])
+    {
+        void* data_buf = data[middle_index];
+        data[middle_index] = data[0];
+        data[0] = data_buf;
+    }
+    if ((int64_t)data[count - 1] < (int64_t)data[middle_index])
+    {
+        void* data_buf = data[count - 1];
+        data[count - 1] = data[middle_index];
+        data[middle_index] = data_buf;
+        if ((int64_t)data[middle_index] < (int64_t)data[0])
+        {
+            data_buf = data[middle_index];
+            data[middle_index] = data[0];
+            data[0] = data_buf;
+        }
+    }
+    int64_t pivot_data = (int64_t)data[middle_index];
+
+    uint64_t left_index = 0;
+    uint64_t right_index = count - 1;
+    while (true)
+    {
+        while ((int64_t)data[left_index] < pivot_data)
+        {
+            left_index++;
+        }
+        while ((int64_t)data[right_index] > pivot_data)
+        {
+            right_index--;
+        }
+        if (left_index >= right_index)
+        {
+            return right_index + 1;
+        }
+        void* data_buf = data[left_index];
+        data[left_index] = data[right_index];
+        data[right_index] = data_buf;
+        left_index++;
+        right_index--;
+    }
+}
 
-    while (index_a < sublist_a->count && index_b < sublist_b->count)
+static void quick_sort_recursive(void** data, uint64_t count, uint8_t depth_limit)
+{
+    while (count > SIMD_SORT_SMALL_MAX)
     {
-        int64_t data_a = (int64_t)list_get(sublist_a, index_a);
-        int64_t data_b = (int64_t)list_get(sublist_b, index_b);
-        if (data_a <= data_b)
+        if (depth_limit == 0)
+        {
+            heap_sort_range(data, count);
+            return;
+        }
+        depth_limit--;
+
+        uint64_t split_index = quick_sort_partition(data, count);
+        if (split_index < count - split_index)
         {
-            list_append(sorted_list, (void*)data_a);
-            index_a++;
+            quick_sort_recursive(data, split_index, depth_limit);
+            data += split_index;
+            count -= split_index;
         }
         else
         {
-            list_append(sorted_list, (void*)data_b);
-            index_b++;
+            quick_sort_recursive(data + split_index, count - split_index, depth_limit);
+            count = split_index;
         }
     }
-    while (index_a < sublist_a->count)
+    simd_sort_small(data, count);
+}
+
+struct list* list_sort_quick(struct list* list)
+{
+    uint8_t depth_limit = 0;
+    for (uint64_t i = list->count; i > 1; i /= 2)
     {
-        list_append(sorted_list, list_get(sublist_a, index_a));
-        index_a++;
+        depth_limit += 2;
     }
-    while (index_b < sublist_b->count)
+    quick_sort_recursive(list->data + 1, list->count, depth_limit);
+    return list;
+}
+
+static void select_swap(void** data, const int64_t index_a, const int64_t index_b)
+{
+    void* data_buf = data[index_a];
+    data[index_a] = data[index_b];
+    data[index_b] = data_buf;
+}
+
+static void select_floyd_rivest(void** data, int64_t left_index, int64_t right_index, const int64_t index)
+{
+    while (right_index > left_index)
     {
-        list_append(sorted_list, list_get(sublist_b, index_b));
-        index_b++;
+        if (right_index - left_index > SELECT_SAMPLE_THRESHOLD)
+        {
+            double count = right_index - left_index + 1;
+            double rank = index - left_index + 1;
+            double log_count = log(count);
+            double sample_size = 0.5 * exp(2 * log_count / 3);
+            double sample_deviation = 0.5 * sqrt(log_count * sample_size * (count - sample_size) / count) * (rank < count / 2 ? -1 : 1);
+            int64_t sample_left = index - (int64_t)(rank * sample_size / count - sample_deviation);
+            int64_t sample_right = index + (int64_t)((count - rank) * sample_size / count + sample_deviation);
+            select_floyd_rivest(data, sample_left > left_index ? sample_left : left_index, sample_right < right_index ? sample_right : right_index, index);
+        }
+
+        int64_t pivot_data = (int64_t)data[index];
+        int64_t low_index = left_index;
+        int64_t high_index = right_index;
+        select_swap(data, left_index, index);
+        if ((int64_t)data[right_index] > pivot_data)
+        {
+            select_swap(data, right_index, left_index);
+        }
+        while (low_index < high_index)
+        {
+            select_swap(data, low_index, high_index);
+            low_index++;
+            high_index--;
+            while ((int64_t)data[low_index] < pivot_data)
+            {
+                low_index++;
+            }
+            while ((int64_t)data[high_index] > pivot_data)
+            {
+                high_index--;
+            }
+        }
+
+        if ((int64_t)data[left_index] == pivot_data)
+        {
+            select_swap(data, left_index, high_index);
+        }
+        else
+        {
+            high_index++;
+            select_swap(data, high_index, right_index);
+        }
+        if (high_index <= index)
+        {
+            left_index = high_index + 1;
+        }
+        if (index <= high_index)
+        {
+            right_index = high_index - 1;
+        }
     }
+}
 
-    list_destroy(sublist_a);
-    list_destroy(sublist_b);
-    return sorted_list;
+int64_t list_select_nth(struct list* list, const uint64_t index)
+{
+    if (index >= list->count)
+    {
+        fprintf(stderr, "list_select_nth: index out of bounds: %llu\n", index);
+        return 0;
+    }
+    select_floyd_rivest(list->data + 1, 0, list->count - 1, index);
+    return (int64_t)list->data[1 + index];
 }
 
-static struct list* merge_sort_recursive(struct list* list)
+struct list* list_partial_sort(struct list* list, const uint64_t count)
 {
-    if (list->count <= 1)
+    if (count >= list->count)
+    {
+        return list_sort_quick(list);
+    }
+    if (count == 0)
     {
         return list;
     }
-    uint64_t middle_index = list->count / 2;
-
-    struct list* sublist_a = list_get_sublist(list, 0, middle_index);
-    struct list* sublist_b = list_get_sublist(list, middle_index, list->count);
-    merge_sort_recursive(sublist_a);
-    merge_sort_recursive(sublist_b);
+    select_floyd_rivest(list->data + 1, 0, list->count - 1, count);
 
-    return merge_sort_merge(sublist_a, sublist_b);
+    uint8_t depth_limit = 0;
+    for (uint64_t i = count; i > 1; i /= 2)
+    {
+        depth_limit += 2;
+    }
+    quick_sort_recursive(list->data + 1, count, depth_limit);
+    return list;
 }
 
-struct list* list_sort_merge(struct list* list)
+struct list* list_top_k(const struct list* list, const uint64_t count)
 {
-    struct list* list_copy = list_create_copy(list);
-    list_copy = merge_sort_recursive(list_copy);
-    *list = *list_copy;
-    free(list_copy);
-    return list;
+    uint64_t top_count = count < list->count ? count : list->count;
+    struct list* top_list = list_create(top_count > 0 ? top_count : 1);
+    if (!top_list || top_count == 0)
+    {
+        return top_list;
+    }
+
+    if (top_count * TOP_K_HEAP_RATIO > list->count)
+    {
+        struct list* list_copy = list_create_copy(list);
+        list_partial_sort(list_copy, top_count);
+        memcpy(top_list->data + 1, list_copy->data + 1, top_count * sizeof(void*));
+        top_list->count = top_count;
+        list_destroy(list_copy);
+        return top_list;
+    }
+
+    void** heap = top_list->data + 1;
+    memcpy(heap, list->data + 1, top_count * sizeof(void*));
+    for (uint64_t i = top_count / 2; i > 0; i--)
+    {
+        heap_sort_sift_down(heap, i - 1, top_count);
+    }
+    for (uint64_t i = top_count; i < list->count; i++)
+    {
+        if ((int64_t)list->data[1 + i] < (int64_t)heap[0])
+        {
+            heap[0] = list->data[1 + i];
+            heap_sort_sift_down(heap, 0, top_count);
+        }
+    }
+    for (uint64_t i = top_count; i > 1; i--)
+    {
+        void* max_data = heap[0];
+        heap[0] = heap[i - 1];
+        heap[i - 1] = max_data;
+        heap_sort_sift_down(heap, 0, i - 1);
+    }
+    top_list->count = top_count;
+    return top_list;
 }
 
-static int64_t quick_sort_partition(struct list* list, const int64_t low_index, const int64_t high_index)
+static uint64_t radix_key(const void* data)
 {
-    int64_t pivot_index = low_index + rand() % (high_index - low_index);
-    int64_t pivot_data = (int64_t)list_get(list, pivot_index);
-    list_swap(list, pivot_index, high_index);
+    return (uint64_t)data ^ (1ULL << 63);
+}
 
-    int64_t left_index = low_index;
-    int64_t right_index = high_index - 1;
+static void radix_sort_range(void** data, void** buffer, const uint64_t count)
+{
+    if (count <= 1)
+    {
+        return;
+    }
+    uint64_t histograms[8][256] = {0};
+    for (uint64_t i = 0; i < count; i++)
+    {
+        uint64_t key = radix_key(data[i]);
+        for (uint8_t pass = 0; pass < 8; pass++)
+        {
+            histograms[pass][(key >> (pass * 8)) & 0xFF]++;
+        }
+    }
 
-    while (left_index <= right_index)
+    void** source = data;
+    void** target = buffer;
+    for (uint8_t pass = 0; pass < 8; pass++)
     {
-        while (left_index <= right_index && (int64_t)list_get(list, left_index) <= pivot_data)
+        uint64_t* histogram = histograms[pass];
+        uint8_t shift = pass * 8;
+        if (histogram[(radix_key(source[0]) >> shift) & 0xFF] == count)
         {
-            left_index++;
+            continue;
         }
-        while (right_index >= left_index && (int64_t)list_get(list, right_index) >= pivot_data)
+
+        uint64_t offset = 0;
+        for (uint16_t i = 0; i < 256; i++)
         {
-            right_index--;
+            uint64_t bucket_count = histogram[i];
+            histogram[i] = offset;
+            offset += bucket_count;
         }
-        if (left_index < right_index)
+        for (uint64_t i = 0; i < count; i++)
         {
-            list_swap(list, left_index, right_index);
+            target[histogram[(radix_key(source[i]) >> shift) & 0xFF]++] = source[i];
         }
+
+        void** swap_buf = source;
+        source = target;
+        target = swap_buf;
     }
 
-    list_swap(list, left_index, high_index);
-    return left_index;
+    if (source != data)
+    {
+        memcpy(data, source, count * sizeof(void*));
+    }
 }
 
-static struct list* quick_sort_recursive(struct list* list, const int64_t low_index, const int64_t high_index)
+struct list* list_sort_radix(struct list* list)
 {
-    if (low_index >= high_index)
+    if (list->count <= 1)
     {
         return list;
     }
-    int64_t pivot_index = quick_sort_partition(list, low_index, high_index);
+    void** buffer = malloc(list->count * list->data_size);
+    if (!buffer)
+    {
+        fprintf(stderr, "list_sort_radix: buffer malloc failed\n");
+        return NULL;
+    }
 
-    quick_sort_recursive(list, low_index, pivot_index - 1);
-    quick_sort_recursive(list, pivot_index + 1, high_index);
+    radix_sort_range(list->data + 1, buffer, list->count);
 
+    free(buffer);
     return list;
 }
 
-struct list* list_sort_quick(struct list* list)
+bool list_view_sort(const struct list_view view)
 {
-    return quick_sort_recursive(list, 0, list->count - 1);
+    if (view.count <= 1)
+    {
+        return true;
+    }
+    if (view.stride == 1 && view.count <= VIEW_SORT_IN_PLACE_THRESHOLD)
+    {
+        uint8_t depth_limit = 0;
+        for (uint64_t i = view.count; i > 1; i /= 2)
+        {
+            depth_limit += 2;
+        }
+        quick_sort_recursive(view.data, view.count, depth_limit);
+        return true;
+    }
+
+    void** buffer = malloc((view.stride == 1 ? 1 : 2) * view.count * sizeof(void*));
+    if (!buffer)
+    {
+        fprintf(stderr, "list_view_sort: buffer malloc failed\n");
+        return false;
+    }
+    void** data = view.data;
+    if (view.stride != 1)
+    {
+        data = buffer + view.count;
+        for (uint64_t i = 0; i < view.count; i++)
+        {
+            data[i] = view.data[(int64_t)i * view.stride];
+        }
+    }
+
+    radix_sort_range(data, buffer, view.count);
+
+    if (view.stride != 1)
+    {
+        for (uint64_t i = 0; i < view.count; i++)
+        {
+            view.data[(int64_t)i * view.stride] = data[i];
+        }
+    }
+    free(buffer);
+    return true;
 }
 
-struct list* bucket_sort_by_digit(struct list* list, const uint64_t exponent)
+struct sort_key
 {
-    struct list* buckets = list_create(32);
-    for (uint8_t i = 0; i < 20; i++)
+    int64_t key;
+    uint64_t index;
+};
+
+static void radix_sort_keys(struct sort_key* keys, struct sort_key* buffer, const uint64_t count)
+{
+    if (count <= 1)
+    {
+        return;
+    }
+    uint64_t histograms[8][256] = {0};
+    for (uint64_t i = 0; i < count; i++)
     {
-        list_append(buckets, list_create(32));
+        uint64_t key = radix_key((void*)keys[i].key);
+        for (uint8_t pass = 0; pass < 8; pass++)
+        {
+            histograms[pass][(key >> (pass * 8)) & 0xFF]++;
+        }
     }
 
+    struct sort_key* source = keys;
+    struct sort_key* target = buffer;
+    for (uint8_t pass = 0; pass < 8; pass++)
+    {
+        uint64_t* histogram = histograms[pass];
+        uint8_t shift = pass * 8;
+        if (histogram[(radix_key((void*)source[0].key) >> shift) & 0xFF] == count)
+        {
+            continue;
+        }
+
+        uint64_t offset = 0;
+        for (uint16_t i = 0; i < 256; i++)
+        {
+            uint64_t bucket_count = histogram[i];
+            histogram[i] = offset;
+            offset += bucket_count;
+        }
+        for (uint64_t i = 0; i < count; i++)
+        {
+            target[histogram[(radix_key((void*)source[i].key) >> shift) & 0xFF]++] = source[i];
+        }
+
+        struct sort_key* swap_buf = source;
+        source = target;
+        target = swap_buf;
+    }
+
+    if (source != keys)
+    {
+        memcpy(keys, source, count * sizeof(struct sort_key));
+    }
+}
+
+struct list* list_sort_by_key(struct list* list, int64_t (*key)(const void*))
+{
+    if (list->count <= 1)
+    {
+        return list;
+    }
+    void** data = list->data + 1;
+    struct sort_key* keys = malloc(2 * list->count * sizeof(struct sort_key));
+    void** buffer = malloc(list->count * list->data_size);
+    if (!keys || !buffer)
+    {
+        fprintf(stderr, "list_sort_by_key: buffer malloc failed\n");
+        free(keys);
+        free(buffer);
+        return NULL;
+    }
+
+    for (uint64_t i = 0; i < list->count; i++)
+    {
+        keys[i].key = key(data[i]);
+        keys[i].index = i;
+    }
+    radix_sort_keys(keys, keys + list->count, list->count);
+
     for (uint64_t i = 0; i < list->count; i++)
     {
-        int64_t number = (int64_t)list_get(list, i);
-        int16_t sign = number < 0 ? -1 : 1;
-        int64_t number_digit = (((sign * number) / exponent) % 10) * sign;
-        list_append(list_get(buckets, 10 + number_digit), (void*)number);
+        buffer[i] = data[keys[i].index];
     }
+    memcpy(data, buffer, list->count * sizeof(void*));
+
+    free(keys);
+    free(buffer);
+    return list;
+}
 
+static void compare_merge_sort_recursive(void** source, void** target, const uint64_t count, const bool into_target, int (*compare)(const void*, const void*, void*), void* context)
+{
+    if (count <= MERGE_SORT_INSERTION_THRESHOLD)
+    {
+        for (uint64_t i = 1; i < count; i++)
+        {
+            void* cur_data = source[i];
+            uint64_t j = i;
+            while (j > 0 && compare(source[j - 1], cur_data, context) > 0)
+            {
+                source[j] = source[j - 1];
+                j--;
+            }
+            source[j] = cur_data;
+        }
+        if (into_target)
+        {
+            memcpy(target, source, count * sizeof(void*));
+        }
+        return;
+    }
+
+    uint64_t middle_index = count / 2;
+    compare_merge_sort_recursive(source, target, middle_index, !into_target, compare, context);
+    compare_merge_sort_recursive(source + middle_index, target + middle_index, count - middle_index, !into_target, compare, context);
+
+    void** merge_source = into_target ? source : target;
+    void** merge_target = into_target ? target : source;
+    uint64_t index_a = 0;
+    uint64_t index_b = middle_index;
     uint64_t index = 0;
-    for (uint8_t i = 0; i < 20; i++)
+    while (index_a < middle_index && index_b < count)
     {
-        struct list* bucket = list_get(buckets, i);
-        for (uint64_t j = 0; j < bucket->count; j++)
+        if (compare(merge_source[index_a], merge_source[index_b], context) <= 0)
         {
-            list_replace(list, list_get(bucket, j), index);
-            index++;
+            merge_target[index++] = merge_source[index_a++];
         }
-        free(bucket);
+        else
+        {
+            merge_target[index++] = merge_source[index_b++];
+        }
+    }
+    memcpy(merge_target + index, merge_source + index_a, (middle_index - index_a) * sizeof(void*));
+    index += middle_index - index_a;
+    memcpy(merge_target + index, merge_source + index_b, (count - index_b) * sizeof(void*));
+}
+
+struct list* list_sort_by(struct list* list, int (*compare)(const void*, const void*, void*), void* context)
+{
+    if (list->count <= 1)
+    {
+        return list;
+    }
+    void** buffer = malloc(list->count * list->data_size);
+    if (!buffer)
+    {
+        fprintf(stderr, "list_sort_by: buffer malloc failed\n");
+        return NULL;
     }
-    free(buckets);
 
+    compare_merge_sort_recursive(list->data + 1, buffer, list->count, false, compare, context);
+
+    free(buffer);
     return list;
 }
 
-struct list* list_sort_radix(struct list* list)
+struct string_sort_task
+{
+    uint64_t start;
+    uint64_t count;
+    uint64_t depth;
+};
+
+static uint64_t string_common_prefix(const char* string_a, const char* string_b, uint64_t depth)
 {
-    uint16_t max_digit_count = 1;
-    int64_t list_max = (int64_t)list_get_max_int(list);
+    while (string_a[depth] != '\0' && string_a[depth] == string_b[depth])
+    {
+        depth++;
+    }
+    return depth;
+}
 
-    for (uint64_t i = 1; list_max / i > 0; i *= 10)
+static void string_insertion_sort(char** strings, const uint64_t count, const uint64_t depth, uint64_t* lcp)
+{
+    for (uint64_t i = 1; i < count; i++)
     {
-        bucket_sort_by_digit(list, i);
+        char* cur_string = strings[i];
+        uint64_t j = i;
+        while (j > 0 && strcmp(strings[j - 1] + depth, cur_string + depth) > 0)
+        {
+            strings[j] = strings[j - 1];
+            j--;
+        }
+        strings[j] = cur_string;
+    }
+    if (lcp == NULL)
+    {
+        return;
+    }
+    for (uint64_t i = 1; i < count; i++)
+    {
+        lcp[i] = string_common_prefix(strings[i - 1], strings[i], depth);
+    }
+}
+
+static void string_radix_sort(char** strings, char** buffer, uint8_t* chars, const uint64_t count, uint64_t* lcp, struct string_sort_task* stack)
+{
+    uint64_t stack_count = 0;
+    stack[stack_count++] = (struct string_sort_task){ 0, count, 0 };
+    while (stack_count > 0)
+    {
+        struct string_sort_task task = stack[--stack_count];
+        char** task_strings = strings + task.start;
+        uint8_t* task_chars = chars + task.start;
+        uint64_t* task_lcp = lcp == NULL ? NULL : lcp + task.start;
+        uint64_t depth = task.depth;
+        if (task.count < STRING_SORT_INSERTION_THRESHOLD)
+        {
+            string_insertion_sort(task_strings, task.count, depth, task_lcp);
+            continue;
+        }
+
+        uint64_t bucket_starts[257];
+        while (true)
+        {
+            memset(bucket_starts, 0, sizeof(bucket_starts));
+            for (uint64_t i = 0; i < task.count; i++)
+            {
+                task_chars[i] = task_strings[i][depth];
+                bucket_starts[task_chars[i] + 1]++;
+            }
+            if (task_chars[0] == '\0' || bucket_starts[task_chars[0] + 1] != task.count)
+            {
+                break;
+            }
+            depth++;
+        }
+
+        for (uint16_t i = 1; i <= 256; i++)
+        {
+            bucket_starts[i] += bucket_starts[i - 1];
+        }
+        uint64_t bucket_offsets[256];
+        memcpy(bucket_offsets, bucket_starts, sizeof(bucket_offsets));
+        for (uint64_t i = 0; i < task.count; i++)
+        {
+            buffer[bucket_offsets[task_chars[i]]++] = task_strings[i];
+        }
+        memcpy(task_strings, buffer, task.count * sizeof(char*));
+
+        for (uint16_t i = 0; i < 256; i++)
+        {
+            uint64_t bucket_start = bucket_starts[i];
+            uint64_t bucket_count = bucket_starts[i + 1] - bucket_start;
+            if (bucket_count == 0)
+            {
+                continue;
+            }
+            if (task_lcp != NULL && bucket_start > 0)
+            {
+                task_lcp[bucket_start] = depth;
+            }
+            if (i == 0)
+            {
+                for (uint64_t j = 1; task_lcp != NULL && j < bucket_count; j++)
+                {
+                    task_lcp[bucket_start + j] = depth;
+                }
+            }
+            else if (bucket_count < STRING_SORT_INSERTION_THRESHOLD)
+            {
+                string_insertion_sort(task_strings + bucket_start, bucket_count, depth + 1, task_lcp == NULL ? NULL : task_lcp + bucket_start);
+            }
+            else
+            {
+                stack[stack_count++] = (struct string_sort_task){ task.start + bucket_start, bucket_count, depth + 1 };
+            }
+        }
+    }
+}
+
+struct list* list_sort_strings(struct list* list, struct list* lcp_list)
+{
+    char** buffer = malloc(list->count * sizeof(char*));
+    uint8_t* chars = malloc(list->count);
+    uint64_t* lcp = lcp_list == NULL ? NULL : calloc(list->count, sizeof(uint64_t));
+    struct string_sort_task* stack = malloc((list->count / STRING_SORT_INSERTION_THRESHOLD + 1) * sizeof(struct string_sort_task));
+    if ((list->count > 0 && (!buffer || !chars)) || (lcp_list != NULL && list->count > 0 && !lcp) || !stack)
+    {
+        fprintf(stderr, "list_sort_strings: buffer malloc failed\n");
+        free(buffer);
+        free(chars);
+        free(lcp);
+        free(stack);
+        return NULL;
+    }
+
+    string_radix_sort((char**)(list->data + 1), buffer, chars, list->count, lcp, stack);
+
+    if (lcp_list != NULL)
+    {
+        list_clear(lcp_list);
+        for (uint64_t i = 0; i < list->count; i++)
+        {
+            list_append(lcp_list, (void*)lcp[i]);
+        }
+    }
+
+    free(buffer);
+    free(chars);
+    free(lcp);
+    free(stack);
+    return list;
+}
+
+struct sample_sort_context
+{
+    void** data;
+    void** buffer;
+    uint8_t* oracle;
+    uint64_t count;
+    uint64_t thread_count;
+    uint64_t bucket_count;
+    uint8_t tree_depth;
+    int64_t splitter_tree[SAMPLE_SORT_MAX_BUCKETS];
+    uint64_t* bucket_offsets;
+    uint64_t bucket_starts[SAMPLE_SORT_MAX_BUCKETS + 1];
+    atomic_uint_fast64_t next_bucket;
+};
+
+struct sample_sort_task
+{
+    struct sample_sort_context* context;
+    uint64_t thread_index;
+};
+
+static uint64_t sample_sort_chunk_start(const struct sample_sort_context* context, const uint64_t thread_index)
+{
+    return context->count * thread_index / context->thread_count;
+}
+
+static uint64_t sample_sort_classify(const struct sample_sort_context* context, const int64_t key)
+{
+    uint64_t index = 1;
+    for (uint8_t level = 0; level < context->tree_depth; level++)
+    {
+        index = 2 * index + (key > context->splitter_tree[index]);
+    }
+    return index - context->bucket_count;
+}
+
+static uint64_t splitter_tree_fill(int64_t* splitter_tree, void** splitters, const uint64_t bucket_count, const uint64_t index, uint64_t next_splitter)
+{
+    if (index >= bucket_count)
+    {
+        return next_splitter;
+    }
+    next_splitter = splitter_tree_fill(splitter_tree, splitters, bucket_count, 2 * index, next_splitter);
+    splitter_tree[index] = (int64_t)splitters[next_splitter];
+    return splitter_tree_fill(splitter_tree, splitters, bucket_count, 2 * index + 1, next_splitter + 1);
+}
+
+static bool sample_sort_select_splitters(struct sample_sort_context* context)
+{
+    uint64_t sample_count = context->bucket_count * SAMPLE_SORT_OVERSAMPLING;
+    void** samples = malloc(2 * sample_count * sizeof(void*));
+    if (!samples)
+    {
+        return false;
+    }
+
+    uint64_t random_state = context->count * 0x9E3779B97F4A7C15ULL + 1;
+    for (uint64_t i = 0; i < sample_count; i++)
+    {
+        random_state ^= random_state << 13;
+        random_state ^= random_state >> 7;
+        random_state ^= random_state << 17;
+        samples[i] = context->data[random_state % context->count];
+    }
+    radix_sort_range(samples, samples + sample_count, sample_count);
+
+    for (uint64_t i = 0; i < context->bucket_count - 1; i++)
+    {
+        samples[i] = samples[(i + 1) * SAMPLE_SORT_OVERSAMPLING];
+    }
+    splitter_tree_fill(context->splitter_tree, samples, context->bucket_count, 1, 0);
+
+    free(samples);
+    return true;
+}
+
+static void* sample_sort_count_buckets(void* arg)
+{
+    struct sample_sort_task* task = arg;
+    struct sample_sort_context* context = task->context;
+    uint64_t* bucket_counts = context->bucket_offsets + task->thread_index * context->bucket_count;
+    uint64_t chunk_end = sample_sort_chunk_start(context, task->thread_index + 1);
+
+    for (uint64_t i = sample_sort_chunk_start(context, task->thread_index); i < chunk_end; i++)
+    {
+        uint64_t bucket = sample_sort_classify(context, (int64_t)context->data[i]);
+        context->oracle[i] = bucket;
+        bucket_counts[bucket]++;
+    }
+    return NULL;
+}
+
+static void* sample_sort_scatter(void* arg)
+{
+    struct sample_sort_task* task = arg;
+    struct sample_sort_context* context = task->context;
+    uint64_t* bucket_offsets = context->bucket_offsets + task->thread_index * context->bucket_count;
+    uint64_t chunk_end = sample_sort_chunk_start(context, task->thread_index + 1);
+
+    for (uint64_t i = sample_sort_chunk_start(context, task->thread_index); i < chunk_end; i++)
+    {
+        context->buffer[bucket_offsets[context->oracle[i]]++] = context->data[i];
+    }
+    return NULL;
+}
+
+static void* sample_sort_sort_buckets(void* arg)
+{
+    struct sample_sort_task* task = arg;
+    struct sample_sort_context* context = task->context;
+
+    uint64_t bucket;
+    while ((bucket = atomic_fetch_add(&context->next_bucket, 1)) < context->bucket_count)
+    {
+        uint64_t bucket_start = context->bucket_starts[bucket];
+        uint64_t bucket_count = context->bucket_starts[bucket + 1] - bucket_start;
+        radix_sort_range(context->buffer + bucket_start, context->data + bucket_start, bucket_count);
+        memcpy(context->data + bucket_start, context->buffer + bucket_start, bucket_count * sizeof(void*));
+    }
+    return NULL;
+}
+
+static void sample_sort_run_threads(struct sample_sort_context* context, void* (*routine)(void*))
+{
+    pthread_t threads[context->thread_count];
+    struct sample_sort_task tasks[context->thread_count];
+    bool is_forked[context->thread_count];
+
+    for (uint64_t i = 0; i < context->thread_count; i++)
+    {
+        tasks[i].context = context;
+        tasks[i].thread_index = i;
+        is_forked[i] = i > 0 && !pthread_create(&threads[i], NULL, routine, &tasks[i]);
+    }
+    for (uint64_t i = 0; i < context->thread_count; i++)
+    {
+        if (!is_forked[i])
+        {
+            routine(&tasks[i]);
+        }
+    }
+    for (uint64_t i = 1; i < context->thread_count; i++)
+    {
+        if (is_forked[i])
+        {
+            pthread_join(threads[i], NULL);
+        }
+    }
+}
+
+struct list* list_sort_parallel(struct list* list)
+{
+    uint64_t thread_count = sort_thread_count();
+    if (list->count < SAMPLE_SORT_THRESHOLD || thread_count <= 1)
+    {
+        return list_sort_radix(list);
+    }
+
+    struct sample_sort_context* context = calloc(1, sizeof(struct sample_sort_context));
+    if (!context)
+    {
+        fprintf(stderr, "list_sort_parallel: context malloc failed\n");
+        return NULL;
+    }
+    context->data = list->data + 1;
+    context->count = list->count;
+    context->thread_count = thread_count;
+    context->bucket_count = 2;
+    context->tree_depth = 1;
+    while (context->bucket_count < SAMPLE_SORT_MAX_BUCKETS && context->bucket_count < 4 * thread_count)
+    {
+        context->bucket_count *= 2;
+        context->tree_depth++;
+    }
+    context->buffer = malloc(list->count * list->data_size);
+    context->oracle = malloc(list->count);
+    context->bucket_offsets = calloc(thread_count * context->bucket_count, sizeof(uint64_t));
+
+    if (!context->buffer || !context->oracle || !context->bucket_offsets || !sample_sort_select_splitters(context))
+    {
+        fprintf(stderr, "list_sort_parallel: buffer malloc failed\n");
+        free(context->buffer);
+        free(context->oracle);
+        free(context->bucket_offsets);
+        free(context);
+        return NULL;
+    }
+
+    sample_sort_run_threads(context, sample_sort_count_buckets);
+
+    uint64_t offset = 0;
+    for (uint64_t bucket = 0; bucket < context->bucket_count; bucket++)
+    {
+        context->bucket_starts[bucket] = offset;
+        for (uint64_t thread = 0; thread < thread_count; thread++)
+        {
+            uint64_t* bucket_offset = &context->bucket_offsets[thread * context->bucket_count + bucket];
+            uint64_t bucket_count = *bucket_offset;
+            *bucket_offset = offset;
+            offset += bucket_count;
+        }
     }
+    context->bucket_starts[context->bucket_count] = offset;
 
+    sample_sort_run_threads(context, sample_sort_scatter);
+    atomic_init(&context->next_bucket, 0);
+    sample_sort_run_threads(context, sample_sort_sort_buckets);
 
+    free(context->buffer);
+    free(context->oracle);
+    free(context->bucket_offsets);
+    free(context);
     return list;
 }
@@ -9,8 +9,20 @@ struct list* list_sort_selection(struct list* list);
 struct list* list_sort_insertion(struct list* list);
 struct list* list_sort_heap(struct list* list);
 struct list* list_sort_merge(struct list* list);
+struct list* list_sort_adaptive(struct list* list);
 struct list* list_sort_quick(struct list* list);
 struct list* list_sort_radix(struct list* list);
+struct list* list_sort_parallel(struct list* list);
+bool list_view_sort(const struct list_view view);
+uint8_t list_sort_thread_depth(void);
+
+int64_t list_select_nth(struct list* list, const uint64_t index);
+struct list* list_partial_sort(struct list* list, const uint64_t count);
+struct list* list_top_k(const struct list* list, const uint64_t count);
+
+struct list* list_sort_by(struct list* list, int (*compare)(const void*, const void*, void*), void* context);
+struct list* list_sort_by_key(struct list* list, int64_t (*key)(const void*));
+struct list* list_sort_strings(struct list* list, struct list* lcp_list);
 
 
 #endif
@@ -1,20 +1,29 @@
 #include "list.h"
 
 
-static bool list_realloc(struct list* list, uint64_t size)
+static bool list_resize(struct list* list, uint64_t size)
 {
-    void** tmp = realloc(list->data, size); 
+    void** tmp = realloc(list->data, size);
     if (!tmp)
     {
-        fprintf(stderr, "list_realloc: realloc failed\n");
-        free(list->data);
-        free(list);
         return false;
     }
     list->data = tmp;
     return true;
 }
 
+static bool list_realloc(struct list* list, uint64_t size)
+{
+    if (list_resize(list, size))
+    {
+        return true;
+    }
+    fprintf(stderr, "list_realloc: realloc failed\n");
+    free(list->data);
+    free(list);
+    return false;
+}
+
 struct list* list_create(const uint64_t size)
 {
     struct list* list = calloc(1, sizeof(struct list));
@@ -41,11 +50,13 @@ struct list* list_create(const uint64_t size)
 
 struct list* list_create_copy(const struct list* list)
 {
-    struct list* list_copy = list_create(32);
-    for (uint64_t i = 0; i < list->count; i++)
+    struct list* list_copy = list_create(list->count > 0 ? list->count : 1);
+    if (!list_copy)
     {
-        list_append(list_copy, list_get(list, i));
+        return NULL;
     }
+    memcpy(list_copy->data + 1, list->data + 1, list->count * list->data_size);
+    list_copy->count = list->count;
     return list_copy;
 }
 
@@ -55,6 +66,47 @@ void list_destroy(struct list* list)
     free(list);
 }
 
+bool list_reserve(struct list* list, const uint64_t size)
+{
+    if (size <= list->size)
+    {
+        return true;
+    }
+    if (!list_resize(list, list->data_size + size * list->data_size))
+    {
+        fprintf(stderr, "list_reserve: realloc failed\n");
+        return false;
+    }
+    list->size = size;
+    return true;
+}
+
+bool list_shrink_to_fit(struct list* list)
+{
+    uint64_t size = list->count > 0 ? list->count : 1;
+    if (size >= list->size)
+    {
+        return true;
+    }
+    if (!list_resize(list, list->data_size + size * list->data_size))
+    {
+        fprintf(stderr, "list_shrink_to_fit: realloc failed\n");
+        return false;
+    }
+    list->size = size;
+    return true;
+}
+
+static bool list_grow(struct list* list, const uint64_t count)
+{
+    if (list->count + count <= list->size)
+    {
+        return true;
+    }
+    uint64_t size = list->size * 2 > list->count + count ? list->size * 2 : list->count + count;
+    return list_reserve(list, size);
+}
+
 void list_append(struct list* list, void* data)
 {
     if (list->count >= list->size)
@@ -86,14 +138,48 @@ void list_insert(struct list* list, void* data, const uint64_t index)
         list->size *= 2;
     }
 
-    for (uint64_t i = 1 + list->count; i > 1 + index; i--)
-    {
-        list->data[i] = list->data[i - 1];    
-    }
+    memmove(list->data + 2 + index, list->data + 1 + index, (list->count - index) * list->data_size);
     list->data[1 + index] = data;
     list->count++;
 }
 
+void list_append_array(struct list* list, void** data, const uint64_t count)
+{
+    if (!list_grow(list, count))
+    {
+        return;
+    }
+    memcpy(list->data + 1 + list->count, data, count * list->data_size);
+    list->count += count;
+}
+
+void list_extend(struct list* list, const struct list* other)
+{
+    uint64_t count = other->count;
+    if (!list_grow(list, count))
+    {
+        return;
+    }
+    memcpy(list->data + 1 + list->count, other->data + 1, count * list->data_size);
+    list->count += count;
+}
+
+void list_insert_many(struct list* list, void** data, const uint64_t count, const uint64_t index)
+{
+    if (index > list->count)
+    {
+        fprintf(stderr, "list_insert_many: index out of bounds\n");
+        return;
+    }
+    if (!list_grow(list, count))
+    {
+        return;
+    }
+    memmove(list->data + 1 + index + count, list->data + 1 + index, (list->count - index) * list->data_size);
+    memcpy(list->data + 1 + index, data, count * list->data_size);
+    list->count += count;
+}
+
 void list_replace(struct list* list, void* data, const uint64_t index)
 {
     if (index >= list->count)
@@ -115,10 +201,7 @@ void* list_remove_at(struct list* list, const uint64_t index)
     }
     void* data_buf = list->data[1 + index];
 
-    for (uint64_t i = index + 2; i <= list->count; i++)
-    {
-        list->data[(i - 1)] = list->data[i];
-    }
+    memmove(list->data + 1 + index, list->data + 2 + index, (list->count - index - 1) * list->data_size);
 
     list->data[list->count] = NULL;
     list->count--;
@@ -126,6 +209,17 @@ void* list_remove_at(struct list* list, const uint64_t index)
     return data_buf;
 }
 
+void list_remove_range(struct list* list, const uint64_t from_index, const uint64_t to_index)
+{
+    if (from_index > to_index || to_index > list->count)
+    {
+        fprintf(stderr, "list_remove_range: index out of bounds\n");
+        return;
+    }
+    memmove(list->data + 1 + from_index, list->data + 1 + to_index, (list->count - to_index) * list->data_size);
+    list->count -= to_index - from_index;
+}
+
 void* list_remove(struct list* list, void* data)
 {
     for (uint64_t i = 0; i < list->count; i++)
@@ -178,11 +272,18 @@ struct list *list_swap(struct list* list, const uint64_t index_a, const uint64_t
 
 struct list* list_get_sublist(const struct list* list, const uint64_t from_index, const uint64_t to_index)
 {
-    struct list* sublist = list_create(32);
-    for (uint64_t i = from_index; i < to_index; i++)
+    if (from_index > to_index || to_index > list->count)
     {
-        list_append(sublist, list_get(list, i));
+        fprintf(stderr, "list_get_sublist: index out of bounds\n");
+        return NULL;
     }
+    struct list* sublist = list_create(to_index > from_index ? to_index - from_index : 1);
+    if (!sublist)
+    {
+        return NULL;
+    }
+    memcpy(sublist->data + 1, list->data + 1 + from_index, (to_index - from_index) * list->data_size);
+    sublist->count = to_index - from_index;
     return sublist;
 }
 
@@ -199,9 +300,76 @@ void* list_get(const struct list* list, const uint64_t index)
 
 bool list_contains(const struct list* list, const void* data)
 {
-    for (uint64_t i = 0; i < list->count; i++)
+    return list_view_contains(list_view_create(list, 0, list->count), data);
+}
+
+int64_t list_get_max_int(const struct list* list)
+{
+    return list_view_get_max_int(list_view_create(list, 0, list->count));
+}
+
+int64_t list_get_min_int(const struct list* list)
+{
+    return list_view_get_min_int(list_view_create(list, 0, list->count));
+}
+
+uint64_t list_sorted_prefix_int(const struct list* list)
+{
+    return list_view_sorted_prefix_int(list_view_create(list, 0, list->count));
+}
+
+bool list_is_sorted_int(struct list* list)
+{
+    return list_sorted_prefix_int(list) == list->count;
+}
+
+
+struct list_view list_view_create(const struct list* list, const uint64_t from_index, const uint64_t to_index)
+{
+    if (from_index > to_index || to_index > list->count)
+    {
+        fprintf(stderr, "list_view_create: index out of bounds\n");
+        return (struct list_view){ list->data + 1, 0, 1 };
+    }
+    return (struct list_view){ list->data + 1 + from_index, to_index - from_index, 1 };
+}
+
+struct list_view list_view_create_strided(const struct list* list, const uint64_t from_index, const uint64_t count, const int64_t stride)
+{
+    int64_t last_index = (int64_t)from_index + (count > 0 ? (int64_t)(count - 1) * stride : 0);
+    if (from_index >= list->count || last_index < 0 || last_index >= (int64_t)list->count)
+    {
+        fprintf(stderr, "list_view_create_strided: index out of bounds\n");
+        return (struct list_view){ list->data + 1, 0, 1 };
+    }
+    return (struct list_view){ list->data + 1 + from_index, count, stride };
+}
+
+struct list_view list_view_subview(const struct list_view view, const uint64_t from_index, const uint64_t to_index)
+{
+    if (from_index > to_index || to_index > view.count)
+    {
+        fprintf(stderr, "list_view_subview: index out of bounds\n");
+        return (struct list_view){ view.data, 0, view.stride };
+    }
+    return (struct list_view){ view.data + (int64_t)from_index * view.stride, to_index - from_index, view.stride };
+}
+
+void* list_view_get(const struct list_view view, const uint64_t index)
+{
+    if (index >= view.count)
     {
-        if (list->data[1 + i] == data)
+        fprintf(stderr, "list_view_get: index out of bounds: %llu\n", index);
+        return NULL;
+    }
+    return view.data[(int64_t)index * view.stride];
+}
+
+bool list_view_contains(const struct list_view view, const void* data)
+{
+    for (uint64_t i = 0; i < view.count; i++)
+    {
+        if (view.data[(int64_t)i * view.stride] == data)
         {
             return true;
         }
@@ -209,52 +377,55 @@ bool list_contains(const struct list* list, const void* data)
     return false;
 }
 
-int64_t list_get_max_int(const struct list* list)
+int64_t list_view_get_max_int(const struct list_view view)
 {
-    if (list->count == 0)
+    if (view.count == 0)
     {
         fprintf(stderr, "list_get_max: list is empty\n");
         return 0;
     }
-    int64_t max = (int64_t)list->data[1];
-    for (uint64_t i = 1; i <= list->count; i++)
+    int64_t max = (int64_t)view.data[0];
+    for (uint64_t i = 1; i < view.count; i++)
     {
-        if ((int64_t)list->data[i] > max)
-        {
-            max = (int64_t)list->data[i];
-        }
+        int64_t cur_data = (int64_t)view.data[(int64_t)i * view.stride];
+        max = cur_data > max ? cur_data : max;
     }
     return max;
 }
 
-int64_t list_get_min_int(const struct list* list)
+int64_t list_view_get_min_int(const struct list_view view)
 {
-    if (list->count == 0)
+    if (view.count == 0)
     {
         fprintf(stderr, "list_get_min: list is empty\n");
-        return NULL;
+        return 0;
     }
-    int64_t min = (int64_t)list->data[1];
-    for (uint64_t i = 1; i <= list->count; i++)
+    int64_t min = (int64_t)view.data[0];
+    for (uint64_t i = 1; i < view.count; i++)
     {
-        if ((int64_t)list->data[i] < min)
-        {
-            min = (int64_t)list->data[i];
-        }
+        int64_t cur_data = (int64_t)view.data[(int64_t)i * view.stride];
+        min = cur_data < min ? cur_data : min;
     }
     return min;
 }
 
-bool list_is_sorted_int(struct list* list)
+uint64_t list_view_sorted_prefix_int(const struct list_view view)
 {
-    for (uint64_t i = 0; i < list->count - 1; i++)
+    if (view.count == 0)
     {
-        if ((int64_t)list_get(list, i) > (int64_t)list_get(list, i + 1))
-        {
-            return false;
-        }
+        return 0;
     }
-    return true;
+    uint64_t index = 1;
+    while (index < view.count && (int64_t)view.data[(int64_t)(index - 1) * view.stride] <= (int64_t)view.data[(int64_t)index * view.stride])
+    {
+        index++;
+    }
+    return index;
+}
+
+bool list_view_is_sorted_int(const struct list_view view)
+{
+    return list_view_sorted_prefix_int(view) == view.count;
 }
 
 
@@ -18,16 +18,31 @@ struct list
     void **data;
 };
 
+struct list_view
+{
+    void** data;
+    uint64_t count;
+    int64_t stride;
+};
+
 struct list* list_create(const uint64_t size);
 struct list* list_create_copy(const struct list* list);
 void list_destroy(struct list* list);
 
+bool list_reserve(struct list* list, const uint64_t size);
+bool list_shrink_to_fit(struct list* list);
+
 void list_append(struct list* list, void* data);
 void list_insert(struct list* list, void* data, const uint64_t index);
 void list_replace(struct list* list, void* data, const uint64_t index);
 
+void list_append_array(struct list* list, void** data, const uint64_t count);
+void list_extend(struct list* list, const struct list* other);
+void list_insert_many(struct list* list, void** data, const uint64_t count, const uint64_t index);
+
 void* list_remove_at(struct list* list, const uint64_t index);
 void* list_remove(struct list* list, void* data);
+void list_remove_range(struct list* list, const uint64_t from_index, const uint64_t to_index);
 void list_clear(struct list* list);
 
 struct list* list_reverse(struct list* list);
@@ -40,8 +55,21 @@ bool list_contains(const struct list* list, const void* data);
 
 int64_t list_get_max_int(const struct list* list);
 int64_t list_get_min_int(const struct list* list);
+uint64_t list_sorted_prefix_int(const struct list* list);
 bool list_is_sorted_int(struct list* list);
 
+struct list_view list_view_create(const struct list* list, const uint64_t from_index, const uint64_t to_index);
+struct list_view list_view_create_strided(const struct list* list, const uint64_t from_index, const uint64_t count, const int64_t stride);
+struct list_view list_view_subview(const struct list_view view, const uint64_t from_index, const uint64_t to_index);
+
+void* list_view_get(const struct list_view view, const uint64_t index);
+bool list_view_contains(const struct list_view view, const void* data);
+
+int64_t list_view_get_max_int(const struct list_view view);
+int64_t list_view_get_min_int(const struct list_view view);
+uint64_t list_view_sorted_prefix_int(const struct list_view view);
+bool list_view_is_sorted_int(const struct list_view view);
+
 void list_print_int(const struct list* list);
 void list_print_char(const struct list* list);
 
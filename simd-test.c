@@ -0,0 +1,126 @@
+#include "simd.h"
+#include "list.h"
+#include "list-search.h"
+#include <stdio.h>
+
+#define TEST_ROUNDS 2000
+#define TEST_MAX_COUNT 300
+#define TEST_GALLOP_RATIO 40
+
+
+static uint64_t test_random(uint64_t* state)
+{
+    *state ^= *state << 13;
+    *state ^= *state >> 7;
+    *state ^= *state << 17;
+    return *state;
+}
+
+static struct list* test_sorted_list(uint64_t* state, const uint64_t count, const uint64_t key_range)
+{
+    struct list* list = list_create(count > 0 ? count : 1);
+    int64_t value = 1;
+    for (uint64_t i = 0; i < count; i++)
+    {
+        value += test_random(state) % key_range < key_range / 2 ? 0 : (int64_t)(test_random(state) % 3) + 1;
+        list_append(list, (void*)value);
+    }
+    return list;
+}
+
+static uint64_t reference_intersect(const struct list* list_a, const struct list* list_b, void** target)
+{
+    uint64_t index_b = 0;
+    uint64_t count = 0;
+    for (uint64_t i = 0; i < list_a->count; i++)
+    {
+        int64_t value = (int64_t)list_a->data[1 + i];
+        while (index_b < list_b->count && (int64_t)list_b->data[1 + index_b] < value)
+        {
+            index_b++;
+        }
+        if (index_b < list_b->count && (int64_t)list_b->data[1 + index_b] == value)
+        {
+            target[count++] = list_a->data[1 + i];
+            index_b++;
+        }
+    }
+    return count;
+}
+
+static bool check_intersect(const struct list* list_a, const struct list* list_b)
+{
+    const struct list* small_list = list_a->count <= list_b->count ? list_a : list_b;
+    const struct list* large_list = small_list == list_a ? list_b : list_a;
+    uint64_t capacity = small_list->count > 0 ? small_list->count : 1;
+    void** expected = malloc(capacity * sizeof(void*));
+    void** simd = malloc(capacity * sizeof(void*));
+    uint64_t expected_count = reference_intersect(small_list, large_list, expected);
+    uint64_t simd_count = simd_intersect_sorted(small_list->data + 1, small_list->count, large_list->data + 1, large_list->count, simd);
+    struct list* intersection = list_intersect_sorted(list_a, list_b);
+
+    bool is_equal = simd_count == expected_count && intersection->count == expected_count;
+    for (uint64_t i = 0; is_equal && i < expected_count; i++)
+    {
+        is_equal = simd[i] == expected[i] && intersection->data[1 + i] == expected[i];
+    }
+    if (!is_equal)
+    {
+        fprintf(stderr, "check_intersect: mismatch for counts %lu and %lu (expected %lu, simd %lu, list %lu)\n", list_a->count, list_b->count, expected_count, simd_count, intersection->count);
+    }
+    list_destroy(intersection);
+    free(simd);
+    free(expected);
+    return is_equal;
+}
+
+static bool test_fixed(void)
+{
+    int64_t values_a[] = {5, 5, 5, 6};
+    int64_t values_b[] = {1, 2, 3, 5, 5, 6, 7, 8};
+    struct list* list_a = list_create(4);
+    struct list* list_b = list_create(8);
+    for (uint64_t i = 0; i < 4; i++)
+    {
+        list_append(list_a, (void*)values_a[i]);
+    }
+    for (uint64_t i = 0; i < 8; i++)
+    {
+        list_append(list_b, (void*)values_b[i]);
+    }
+    bool is_passed = check_intersect(list_a, list_b) && check_intersect(list_b, list_a);
+    list_destroy(list_a);
+    list_destroy(list_b);
+    return is_passed;
+}
+
+static bool test_random_duplicates(void)
+{
+    uint64_t state = 0x9E3779B97F4A7C15ull;
+    for (uint64_t round = 0; round < TEST_ROUNDS; round++)
+    {
+        uint64_t count_a = test_random(&state) % TEST_MAX_COUNT;
+        uint64_t count_b = round % 4 == 0 ? count_a * TEST_GALLOP_RATIO + 1 : test_random(&state) % TEST_MAX_COUNT;
+        uint64_t key_range = 2 + test_random(&state) % 8;
+        struct list* list_a = test_sorted_list(&state, count_a, key_range);
+        struct list* list_b = test_sorted_list(&state, count_b, key_range);
+        bool is_passed = check_intersect(list_a, list_b);
+        list_destroy(list_a);
+        list_destroy(list_b);
+        if (!is_passed)
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+int main(void)
+{
+    if (!test_fixed() || !test_random_duplicates())
+    {
+        return 1;
+    }
+    printf("simd-test: ok (avx2 %s)\n", simd_has_avx2() ? "on" : "off");
+    return 0;
+}
@@ -0,0 +1,631 @@
+#include "simd.h"
+#include <stdio.h>
+#include <string.h>
+
+#if defined(__x86_64__) || defined(__i386__)
+#define SIMD_X86
+#include <immintrin.h>
+#endif
+
+
+bool simd_has_avx2(void)
+{
+#ifdef SIMD_X86
+    static int has_avx2 = -1;
+    if (has_avx2 < 0)
+    {
+        __builtin_cpu_init();
+        has_avx2 = __builtin_cpu_supports("avx2") ? 1 : 0;
+    }
+    return has_avx2;
+#else
+    return false;
+#endif
+}
+
+
+static void sort_small_scalar(void** data, const uint64_t count)
+{
+    for (uint64_t i = 1; i < count; i++)
+    {
+        void* cur_data = data[i];
+        uint64_t j = i;
+        while (j > 0 && (int64_t)data[j - 1] > (int64_t)cur_data)
+        {
+            data[j] = data[j - 1];
+            j--;
+        }
+        data[j] = cur_data;
+    }
+}
+
+static uint64_t intersect_sorted_scalar(void** data_a, const uint64_t count_a, void** data_b, const uint64_t count_b, void** target)
+{
+    uint64_t index_a = 0;
+    uint64_t index_b = 0;
+    uint64_t count = 0;
+    while (index_a < count_a && index_b < count_b)
+    {
+        int64_t value_a = (int64_t)data_a[index_a];
+        int64_t value_b = (int64_t)data_b[index_b];
+        if (value_a == value_b)
+        {
+            target[count++] = data_a[index_a];
+        }
+        index_a += value_a <= value_b;
+        index_b += value_b <= value_a;
+    }
+    return count;
+}
+
+static int64_t min_scalar(const int64_t* data, const uint64_t count)
+{
+    int64_t min = data[0];
+    for (uint64_t i = 1; i < count; i++)
+    {
+        min = data[i] < min ? data[i] : min;
+    }
+    return min;
+}
+
+static int64_t max_scalar(const int64_t* data, const uint64_t count)
+{
+    int64_t max = data[0];
+    for (uint64_t i = 1; i < count; i++)
+    {
+        max = data[i] > max ? data[i] : max;
+    }
+    return max;
+}
+
+static int64_t sum_scalar(const int64_t* data, const uint64_t count)
+{
+    uint64_t sum = 0;
+    for (uint64_t i = 0; i < count; i++)
+    {
+        sum += (uint64_t)data[i];
+    }
+    return (int64_t)sum;
+}
+
+static uint64_t find_scalar(const int64_t* data, const uint64_t count, const int64_t value)
+{
+    for (uint64_t i = 0; i < count; i++)
+    {
+        if (data[i] == value)
+        {
+            return i;
+        }
+    }
+    return count;
+}
+
+static uint64_t count_less_scalar(const int64_t* data, const uint64_t count, const int64_t value)
+{
+    uint64_t less_count = 0;
+    for (uint64_t i = 0; i < count; i++)
+    {
+        less_count += data[i] < value;
+    }
+    return less_count;
+}
+
+static bool is_sorted_scalar(const int64_t* data, const uint64_t count)
+{
+    for (uint64_t i = 1; i < count; i++)
+    {
+        if (data[i - 1] > data[i])
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+static uint32_t pack_load_word(const uint8_t* data, const uint64_t index)
+{
+    uint32_t word;
+    memcpy(&word, data + index * sizeof(uint32_t), sizeof(uint32_t));
+    return word;
+}
+
+static void unpack_block_scalar(const uint8_t* data, const uint8_t bit_width, uint32_t* target)
+{
+    uint32_t mask = bit_width == 32 ? UINT32_MAX : ((uint32_t)1 << bit_width) - 1;
+    for (uint64_t lane = 0; lane < SIMD_PACK_LANES; lane++)
+    {
+        uint64_t bit = 0;
+        for (uint64_t i = lane; i < SIMD_PACK_BLOCK_SIZE; i += SIMD_PACK_LANES)
+        {
+            uint64_t word_index = bit / 32;
+            uint64_t shift = bit % 32;
+            uint32_t value = pack_load_word(data, word_index * SIMD_PACK_LANES + lane) >> shift;
+            if (shift + bit_width > 32)
+            {
+                value |= pack_load_word(data, (word_index + 1) * SIMD_PACK_LANES + lane) << (32 - shift);
+            }
+            target[i] = value & mask;
+            bit += bit_width;
+        }
+    }
+}
+
+static void prefix_sum_scalar(const uint32_t* deltas, const uint64_t count, const int64_t base, int64_t* target)
+{
+    uint64_t sum = (uint64_t)base;
+    for (uint64_t i = 0; i < count; i++)
+    {
+        sum += deltas[i];
+        target[i] = (int64_t)sum;
+    }
+}
+
+#ifdef SIMD_X86
+
+__attribute__((target("avx2")))
+static void compare_exchange_avx2(__m256i* low, __m256i* high)
+{
+    __m256i mask = _mm256_cmpgt_epi64(*low, *high);
+    __m256i min = _mm256_blendv_epi8(*low, *high, mask);
+    __m256i max = _mm256_blendv_epi8(*high, *low, mask);
+    *low = min;
+    *high = max;
+}
+
+__attribute__((target("avx2")))
+static __m256i bitonic_clean_avx2(__m256i data)
+{
+    __m256i swapped = _mm256_permute4x64_epi64(data, 0x4E);
+    __m256i min = data;
+    __m256i max = swapped;
+    compare_exchange_avx2(&min, &max);
+    data = _mm256_blend_epi32(min, max, 0xF0);
+
+    swapped = _mm256_permute4x64_epi64(data, 0xB1);
+    min = data;
+    max = swapped;
+    compare_exchange_avx2(&min, &max);
+    return _mm256_blend_epi32(min, max, 0xCC);
+}
+
+__attribute__((target("avx2")))
+static void bitonic_merge_4_avx2(__m256i* low, __m256i* high)
+{
+    *high = _mm256_permute4x64_epi64(*high, 0x1B);
+    compare_exchange_avx2(low, high);
+    *low = bitonic_clean_avx2(*low);
+    *high = bitonic_clean_avx2(*high);
+}
+
+__attribute__((target("avx2")))
+static void bitonic_merge_8_avx2(__m256i* data)
+{
+    __m256i reversed_0 = _mm256_permute4x64_epi64(data[3], 0x1B);
+    __m256i reversed_1 = _mm256_permute4x64_epi64(data[2], 0x1B);
+    compare_exchange_avx2(&data[0], &reversed_0);
+    compare_exchange_avx2(&data[1], &reversed_1);
+    data[2] = reversed_0;
+    data[3] = reversed_1;
+
+    compare_exchange_avx2(&data[0], &data[1]);
+    compare_exchange_avx2(&data[2], &data[3]);
+    for (uint8_t i = 0; i < 4; i++)
+    {
+        data[i] = bitonic_clean_avx2(data[i]);
+    }
+}
+
+__attribute__((target("avx2")))
+static void sort_small_avx2(void** data, const uint64_t count)
+{
+    int64_t padded[SIMD_SORT_SMALL_MAX];
+    for (uint64_t i = 0; i < SIMD_SORT_SMALL_MAX; i++)
+    {
+        padded[i] = i < count ? (int64_t)data[i] : INT64_MAX;
+    }
+
+    __m256i rows[4];
+    for (uint8_t i = 0; i < 4; i++)
+    {
+        rows[i] = _mm256_loadu_si256((const __m256i*)(padded + 4 * i));
+    }
+
+    compare_exchange_avx2(&rows[0], &rows[1]);
+    compare_exchange_avx2(&rows[2], &rows[3]);
+    compare_exchange_avx2(&rows[0], &rows[2]);
+    compare_exchange_avx2(&rows[1], &rows[3]);
+    compare_exchange_avx2(&rows[1], &rows[2]);
+
+    __m256i low_01 = _mm256_unpacklo_epi64(rows[0], rows[1]);
+    __m256i high_01 = _mm256_unpackhi_epi64(rows[0], rows[1]);
+    __m256i low_23 = _mm256_unpacklo_epi64(rows[2], rows[3]);
+    __m256i high_23 = _mm256_unpackhi_epi64(rows[2], rows[3]);
+    rows[0] = _mm256_permute2x128_si256(low_01, low_23, 0x20);
+    rows[1] = _mm256_permute2x128_si256(high_01, high_23, 0x20);
+    rows[2] = _mm256_permute2x128_si256(low_01, low_23, 0x31);
+    rows[3] = _mm256_permute2x128_si256(high_01, high_23, 0x31);
+
+    bitonic_merge_4_avx2(&rows[0], &rows[1]);
+    bitonic_merge_4_avx2(&rows[2], &rows[3]);
+    bitonic_merge_8_avx2(rows);
+
+    for (uint8_t i = 0; i < 4; i++)
+    {
+        _mm256_storeu_si256((__m256i*)(padded + 4 * i), rows[i]);
+    }
+    for (uint64_t i = 0; i < count; i++)
+    {
+        data[i] = (void*)padded[i];
+    }
+}
+
+static bool block_is_distinct(void** data, const uint64_t index, const uint64_t count)
+{
+    uint64_t start = index > 0 ? index - 1 : 0;
+    uint64_t end = index + 4 < count ? index + 4 : count - 1;
+    for (uint64_t i = start; i < end; i++)
+    {
+        if (data[i] == data[i + 1])
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+__attribute__((target("avx2")))
+static uint64_t intersect_sorted_avx2(void** data_a, const uint64_t count_a, void** data_b, const uint64_t count_b, void** target)
+{
+    uint64_t index_a = 0;
+    uint64_t index_b = 0;
+    uint64_t count = 0;
+    while (index_a + 4 <= count_a && index_b + 4 <= count_b)
+    {
+        if (!block_is_distinct(data_a, index_a, count_a) || !block_is_distinct(data_b, index_b, count_b))
+        {
+            uint64_t end_a = index_a + 4;
+            uint64_t end_b = index_b + 4;
+            while (index_a < end_a && index_b < end_b)
+            {
+                int64_t value_a = (int64_t)data_a[index_a];
+                int64_t value_b = (int64_t)data_b[index_b];
+                if (value_a == value_b)
+                {
+                    target[count++] = data_a[index_a];
+                }
+                index_a += value_a <= value_b;
+                index_b += value_b <= value_a;
+            }
+            continue;
+        }
+
+        __m256i block_a = _mm256_loadu_si256((const __m256i*)(data_a + index_a));
+        __m256i block_b = _mm256_loadu_si256((const __m256i*)(data_b + index_b));
+        __m256i matches = _mm256_cmpeq_epi64(block_a, block_b);
+        matches = _mm256_or_si256(matches, _mm256_cmpeq_epi64(block_a, _mm256_permute4x64_epi64(block_b, 0x39)));
+        matches = _mm256_or_si256(matches, _mm256_cmpeq_epi64(block_a, _mm256_permute4x64_epi64(block_b, 0x4E)));
+        matches = _mm256_or_si256(matches, _mm256_cmpeq_epi64(block_a, _mm256_permute4x64_epi64(block_b, 0x93)));
+
+        uint32_t match_mask = _mm256_movemask_pd(_mm256_castsi256_pd(matches));
+        while (match_mask != 0)
+        {
+            target[count++] = data_a[index_a + __builtin_ctz(match_mask)];
+            match_mask &= match_mask - 1;
+        }
+
+        int64_t max_a = (int64_t)data_a[index_a + 3];
+        int64_t max_b = (int64_t)data_b[index_b + 3];
+        index_a += max_a <= max_b ? 4 : 0;
+        index_b += max_b <= max_a ? 4 : 0;
+    }
+    return count + intersect_sorted_scalar(data_a + index_a, count_a - index_a, data_b + index_b, count_b - index_b, target + count);
+}
+
+__attribute__((target("avx2")))
+static int64_t min_avx2(const int64_t* data, const uint64_t count)
+{
+    if (count < 4)
+    {
+        return min_scalar(data, count);
+    }
+    __m256i min = _mm256_loadu_si256((const __m256i*)data);
+    uint64_t index = 4;
+    for (; index + 4 <= count; index += 4)
+    {
+        __m256i block = _mm256_loadu_si256((const __m256i*)(data + index));
+        min = _mm256_blendv_epi8(min, block, _mm256_cmpgt_epi64(min, block));
+    }
+    int64_t lanes[4];
+    _mm256_storeu_si256((__m256i*)lanes, min);
+    int64_t result = min_scalar(lanes, 4);
+    for (; index < count; index++)
+    {
+        result = data[index] < result ? data[index] : result;
+    }
+    return result;
+}
+
+__attribute__((target("avx2")))
+static int64_t max_avx2(const int64_t* data, const uint64_t count)
+{
+    if (count < 4)
+    {
+        return max_scalar(data, count);
+    }
+    __m256i max = _mm256_loadu_si256((const __m256i*)data);
+    uint64_t index = 4;
+    for (; index + 4 <= count; index += 4)
+    {
+        __m256i block = _mm256_loadu_si256((const __m256i*)(data + index));
+        max = _mm256_blendv_epi8(max, block, _mm256_cmpgt_epi64(block, max));
+    }
+    int64_t lanes[4];
+    _mm256_storeu_si256((__m256i*)lanes, max);
+    int64_t result = max_scalar(lanes, 4);
+    for (; index < count; index++)
+    {
+        result = data[index] > result ? data[index] : result;
+    }
+    return result;
+}
+
+__attribute__((target("avx2")))
+static int64_t sum_avx2(const int64_t* data, const uint64_t count)
+{
+    __m256i sum_a = _mm256_setzero_si256();
+    __m256i sum_b = _mm256_setzero_si256();
+    uint64_t index = 0;
+    for (; index + 8 <= count; index += 8)
+    {
+        sum_a = _mm256_add_epi64(sum_a, _mm256_loadu_si256((const __m256i*)(data + index)));
+        sum_b = _mm256_add_epi64(sum_b, _mm256_loadu_si256((const __m256i*)(data + index + 4)));
+    }
+    int64_t lanes[4];
+    _mm256_storeu_si256((__m256i*)lanes, _mm256_add_epi64(sum_a, sum_b));
+    return (int64_t)((uint64_t)sum_scalar(lanes, 4) + (uint64_t)sum_scalar(data + index, count - index));
+}
+
+__attribute__((target("avx2")))
+static uint64_t find_avx2(const int64_t* data, const uint64_t count, const int64_t value)
+{
+    __m256i needle = _mm256_set1_epi64x(value);
+    uint64_t index = 0;
+    for (; index + 8 <= count; index += 8)
+    {
+        __m256i matches_a = _mm256_cmpeq_epi64(needle, _mm256_loadu_si256((const __m256i*)(data + index)));
+        __m256i matches_b = _mm256_cmpeq_epi64(needle, _mm256_loadu_si256((const __m256i*)(data + index + 4)));
+        uint32_t match_mask = _mm256_movemask_pd(_mm256_castsi256_pd(matches_a)) | _mm256_movemask_pd(_mm256_castsi256_pd(matches_b)) << 4;
+        if (match_mask != 0)
+        {
+            return index + __builtin_ctz(match_mask);
+        }
+    }
+    return index + find_scalar(data + index, count - index, value);
+}
+
+__attribute__((target("avx2")))
+static uint64_t count_less_avx2(const int64_t* data, const uint64_t count, const int64_t value)
+{
+    __m256i needle = _mm256_set1_epi64x(value);
+    __m256i less_a = _mm256_setzero_si256();
+    __m256i less_b = _mm256_setzero_si256();
+    uint64_t index = 0;
+    for (; index + 8 <= count; index += 8)
+    {
+        less_a = _mm256_sub_epi64(less_a, _mm256_cmpgt_epi64(needle, _mm256_loadu_si256((const __m256i*)(data + index))));
+        less_b = _mm256_sub_epi64(less_b, _mm256_cmpgt_epi64(needle, _mm256_loadu_si256((const __m256i*)(data + index + 4))));
+    }
+    int64_t lanes[4];
+    _mm256_storeu_si256((__m256i*)lanes, _mm256_add_epi64(less_a, less_b));
+    return (uint64_t)sum_scalar(lanes, 4) + count_less_scalar(data + index, count - index, value);
+}
+
+__attribute__((target("avx2")))
+static bool is_sorted_avx2(const int64_t* data, const uint64_t count)
+{
+    uint64_t index = 0;
+    for (; index + 5 <= count; index += 4)
+    {
+        __m256i current = _mm256_loadu_si256((const __m256i*)(data + index));
+        __m256i next = _mm256_loadu_si256((const __m256i*)(data + index + 1));
+        if (!_mm256_testz_si256(_mm256_cmpgt_epi64(current, next), _mm256_cmpgt_epi64(current, next)))
+        {
+            return false;
+        }
+    }
+    return is_sorted_scalar(data + index, count - index);
+}
+
+__attribute__((target("avx2")))
+static void unpack_block_avx2(const uint8_t* data, const uint8_t bit_width, uint32_t* target)
+{
+    const __m256i* source = (const __m256i*)data;
+    __m256i mask = _mm256_set1_epi32(bit_width == 32 ? -1 : (int32_t)(((uint32_t)1 << bit_width) - 1));
+    __m256i word = _mm256_loadu_si256(source);
+    uint32_t shift = 0;
+    for (uint64_t i = 0; i < SIMD_PACK_BLOCK_SIZE; i += SIMD_PACK_LANES)
+    {
+        __m256i value = _mm256_srl_epi32(word, _mm_cvtsi32_si128((int32_t)shift));
+        shift += bit_width;
+        if (shift > 32 || (shift == 32 && i + SIMD_PACK_LANES < SIMD_PACK_BLOCK_SIZE))
+        {
+            word = _mm256_loadu_si256(++source);
+            shift -= 32;
+            value = _mm256_or_si256(value, _mm256_sll_epi32(word, _mm_cvtsi32_si128((int32_t)(bit_width - shift))));
+        }
+        _mm256_storeu_si256((__m256i*)(target + i), _mm256_and_si256(value, mask));
+    }
+}
+
+__attribute__((target("avx2")))
+static void prefix_sum_avx2(const uint32_t* deltas, const uint64_t count, const int64_t base, int64_t* target)
+{
+    __m256i carry = _mm256_set1_epi64x(base);
+    uint64_t index = 0;
+    for (; index + 4 <= count; index += 4)
+    {
+        __m256i sum = _mm256_cvtepu32_epi64(_mm_loadu_si128((const __m128i*)(deltas + index)));
+        sum = _mm256_add_epi64(sum, _mm256_blend_epi32(_mm256_permute4x64_epi64(sum, 0x90), _mm256_setzero_si256(), 0x03));
+        sum = _mm256_add_epi64(sum, _mm256_blend_epi32(_mm256_permute4x64_epi64(sum, 0x40), _mm256_setzero_si256(), 0x0F));
+        sum = _mm256_add_epi64(sum, carry);
+        _mm256_storeu_si256((__m256i*)(target + index), sum);
+        carry = _mm256_permute4x64_epi64(sum, 0xFF);
+    }
+    prefix_sum_scalar(deltas + index, count - index, index > 0 ? target[index - 1] : base, target + index);
+}
+
+#endif
+
+void simd_sort_small(void** data, const uint64_t count)
+{
+    if (count <= 1)
+    {
+        return;
+    }
+    if (count > SIMD_SORT_SMALL_MAX)
+    {
+        fprintf(stderr, "simd_sort_small: count exceeds %d\n", SIMD_SORT_SMALL_MAX);
+        return;
+    }
+#ifdef SIMD_X86
+    if (count > 4 && simd_has_avx2())
+    {
+        sort_small_avx2(data, count);
+        return;
+    }
+#endif
+    sort_small_scalar(data, count);
+}
+
+uint64_t simd_intersect_sorted(void** data_a, const uint64_t count_a, void** data_b, const uint64_t count_b, void** target)
+{
+#ifdef SIMD_X86
+    if (simd_has_avx2())
+    {
+        return intersect_sorted_avx2(data_a, count_a, data_b, count_b, target);
+    }
+#endif
+    return intersect_sorted_scalar(data_a, count_a, data_b, count_b, target);
+}
+
+int64_t simd_min_int64(const int64_t* data, const uint64_t count)
+{
+#ifdef SIMD_X86
+    if (simd_has_avx2())
+    {
+        return min_avx2(data, count);
+    }
+#endif
+    return min_scalar(data, count);
+}
+
+int64_t simd_max_int64(const int64_t* data, const uint64_t count)
+{
+#ifdef SIMD_X86
+    if (simd_has_avx2())
+    {
+        return max_avx2(data, count);
+    }
+#endif
+    return max_scalar(data, count);
+}
+
+int64_t simd_sum_int64(const int64_t* data, const uint64_t count)
+{
+#ifdef SIMD_X86
+    if (simd_has_avx2())
+    {
+        return sum_avx2(data, count);
+    }
+#endif
+    return sum_scalar(data, count);
+}
+
+uint64_t simd_find_int64(const int64_t* data, const uint64_t count, const int64_t value)
+{
+#ifdef SIMD_X86
+    if (simd_has_avx2())
+    {
+        return find_avx2(data, count, value);
+    }
+#endif
+    return find_scalar(data, count, value);
+}
+
+uint64_t simd_count_less_int64(const int64_t* data, const uint64_t count, const int64_t value)
+{
+#ifdef SIMD_X86
+    if (simd_has_avx2())
+    {
+        return count_less_avx2(data, count, value);
+    }
+#endif
+    return count_less_scalar(data, count, value);
+}
+
+bool simd_is_sorted_int64(const int64_t* data, const uint64_t count)
+{
+#ifdef SIMD_X86
+    if (simd_has_avx2())
+    {
+        return is_sorted_avx2(data, count);
+    }
+#endif
+    return is_sorted_scalar(data, count);
+}
+
+uint64_t simd_packed_size(const uint8_t bit_width)
+{
+    return (SIMD_PACK_BLOCK_SIZE / SIMD_PACK_LANES * bit_width + 31) / 32 * SIMD_PACK_LANES * sizeof(uint32_t);
+}
+
+void simd_pack_block(const uint32_t* data, const uint8_t bit_width, uint8_t* target)
+{
+    uint64_t word_count = simd_packed_size(bit_width) / sizeof(uint32_t);
+    uint32_t words[SIMD_PACK_BLOCK_SIZE] = {0};
+    for (uint64_t lane = 0; lane < SIMD_PACK_LANES; lane++)
+    {
+        uint64_t bit = 0;
+        for (uint64_t i = lane; i < SIMD_PACK_BLOCK_SIZE; i += SIMD_PACK_LANES)
+        {
+            uint64_t word_index = bit / 32;
+            uint64_t shift = bit % 32;
+            words[word_index * SIMD_PACK_LANES + lane] |= data[i] << shift;
+            if (shift + bit_width > 32)
+            {
+                words[(word_index + 1) * SIMD_PACK_LANES + lane] |= data[i] >> (32 - shift);
+            }
+            bit += bit_width;
+        }
+    }
+    memcpy(target, words, word_count * sizeof(uint32_t));
+}
+
+void simd_unpack_block(const uint8_t* data, const uint8_t bit_width, uint32_t* target)
+{
+    if (bit_width == 0)
+    {
+        memset(target, 0, SIMD_PACK_BLOCK_SIZE * sizeof(uint32_t));
+        return;
+    }
+#ifdef SIMD_X86
+    if (simd_has_avx2())
+    {
+        unpack_block_avx2(data, bit_width, target);
+        return;
+    }
+#endif
+    unpack_block_scalar(data, bit_width, target);
+}
+
+void simd_prefix_sum_int64(const uint32_t* deltas, const uint64_t count, const int64_t base, int64_t* target)
+{
+#ifdef SIMD_X86
+    if (simd_has_avx2())
+    {
+        prefix_sum_avx2(deltas, count, base, target);
+        return;
+    }
+#endif
+    prefix_sum_scalar(deltas, count, base, target);
+}
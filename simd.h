@@ -0,0 +1,29 @@
+#ifndef SIMD_H
+#define SIMD_H
+
+#include <stdlib.h>
+#include <stdint.h>
+#include <stdbool.h>
+
+#define SIMD_SORT_SMALL_MAX 16
+#define SIMD_PACK_BLOCK_SIZE 128
+#define SIMD_PACK_LANES 8
+
+bool simd_has_avx2(void);
+
+void simd_sort_small(void** data, const uint64_t count);
+uint64_t simd_intersect_sorted(void** data_a, const uint64_t count_a, void** data_b, const uint64_t count_b, void** target);
+
+int64_t simd_min_int64(const int64_t* data, const uint64_t count);
+int64_t simd_max_int64(const int64_t* data, const uint64_t count);
+int64_t simd_sum_int64(const int64_t* data, const uint64_t count);
+uint64_t simd_find_int64(const int64_t* data, const uint64_t count, const int64_t value);
+uint64_t simd_count_less_int64(const int64_t* data, const uint64_t count, const int64_t value);
+bool simd_is_sorted_int64(const int64_t* data, const uint64_t count);
+
+uint64_t simd_packed_size(const uint8_t bit_width);
+void simd_pack_block(const uint32_t* data, const uint8_t bit_width, uint8_t* target);
+void simd_unpack_block(const uint8_t* data, const uint8_t bit_width, uint32_t* target);
+void simd_prefix_sum_int64(const uint32_t* deltas, const uint64_t count, const int64_t base, int64_t* target);
+
+#endif
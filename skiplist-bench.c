@@ -0,0 +1,234 @@
+#define _POSIX_C_SOURCE 200809L
+#include "skiplist.h"
+#include "bst.h"
+#include <pthread.h>
+#include <time.h>
+#include <unistd.h>
+
+#define BENCH_KEY_RANGE 1000000
+#define BENCH_OPS_PER_THREAD 1000000
+#define BENCH_MAX_THREADS 64
+#define STRESS_KEYS_PER_THREAD 20000
+#define STRESS_CHURN_OPS 200000
+
+struct bench_task
+{
+    struct skiplist* skiplist;
+    struct bst* bst;
+    pthread_mutex_t* mutex;
+    uint64_t seed;
+    uint64_t thread_id;
+    uint64_t thread_count;
+    bool failed;
+};
+
+
+static uint64_t bench_random(uint64_t* state)
+{
+    *state ^= *state << 13;
+    *state ^= *state >> 7;
+    *state ^= *state << 17;
+    return *state;
+}
+
+static double bench_now(void)
+{
+    struct timespec time;
+    clock_gettime(CLOCK_MONOTONIC, &time);
+    return time.tv_sec + time.tv_nsec / 1e9;
+}
+
+static void* stress_worker(void* arg)
+{
+    struct bench_task* task = arg;
+    for (uint64_t i = 0; i < STRESS_KEYS_PER_THREAD; i++)
+    {
+        int64_t key = i * task->thread_count + task->thread_id;
+        if (!skiplist_insert(task->skiplist, key) || !skiplist_contains(task->skiplist, key))
+        {
+            task->failed = true;
+        }
+    }
+    for (uint64_t i = 0; i < STRESS_KEYS_PER_THREAD; i += 2)
+    {
+        int64_t key = i * task->thread_count + task->thread_id;
+        if (!skiplist_remove(task->skiplist, key) || skiplist_contains(task->skiplist, key) || skiplist_remove(task->skiplist, key))
+        {
+            task->failed = true;
+        }
+    }
+    uint64_t state = task->seed;
+    for (uint64_t i = 0; i < STRESS_CHURN_OPS; i++)
+    {
+        int64_t key = -1 - (int64_t)(bench_random(&state) % 64);
+        if (i & 1)
+        {
+            skiplist_insert(task->skiplist, key);
+        }
+        else
+        {
+            skiplist_remove(task->skiplist, key);
+        }
+        skiplist_contains(task->skiplist, key);
+    }
+    struct list* range = skiplist_get_range(task->skiplist, 0, STRESS_KEYS_PER_THREAD);
+    if (!range)
+    {
+        task->failed = true;
+        return NULL;
+    }
+    for (uint64_t i = 1; i < range->count; i++)
+    {
+        if ((int64_t)list_get(range, i - 1) >= (int64_t)list_get(range, i))
+        {
+            task->failed = true;
+        }
+    }
+    list_destroy(range);
+    return NULL;
+}
+
+static bool stress(const uint64_t thread_count)
+{
+    struct skiplist* skiplist = skiplist_create();
+    pthread_t threads[BENCH_MAX_THREADS];
+    struct bench_task tasks[BENCH_MAX_THREADS];
+    for (uint64_t i = 0; i < thread_count; i++)
+    {
+        tasks[i] = (struct bench_task){ skiplist, NULL, NULL, i * 2654435761ULL + 1, i, thread_count, false };
+        pthread_create(&threads[i], NULL, stress_worker, &tasks[i]);
+    }
+    bool failed = false;
+    for (uint64_t i = 0; i < thread_count; i++)
+    {
+        pthread_join(threads[i], NULL);
+        failed |= tasks[i].failed;
+    }
+
+    uint64_t churn_count = 0;
+    for (int64_t key = -64; key < 0; key++)
+    {
+        churn_count += skiplist_contains(skiplist, key);
+    }
+    uint64_t expected = thread_count * STRESS_KEYS_PER_THREAD / 2;
+    failed |= skiplist_count(skiplist) != expected + churn_count;
+    for (int64_t key = 0; key < (int64_t)(thread_count * STRESS_KEYS_PER_THREAD); key++)
+    {
+        failed |= skiplist_contains(skiplist, key) != ((key / (int64_t)thread_count) % 2 == 1);
+    }
+    skiplist_reclaim(skiplist);
+    uint64_t retired = 0;
+    for (struct skiplist_node* node = atomic_load(&skiplist->retired); node != NULL; node = node->retired_next)
+    {
+        retired++;
+    }
+    failed |= retired != 0;
+    skiplist_destroy(skiplist);
+    printf("stress %llu threads: %s\n", (unsigned long long)thread_count, failed ? "FAILED" : "ok");
+    return !failed;
+}
+
+static void* bench_worker(void* arg)
+{
+    struct bench_task* task = arg;
+    uint64_t state = task->seed;
+    for (uint64_t i = 0; i < BENCH_OPS_PER_THREAD; i++)
+    {
+        uint64_t random = bench_random(&state);
+        int64_t key = random % BENCH_KEY_RANGE;
+        uint64_t op = random >> 62;
+        if (task->skiplist != NULL)
+        {
+            if (op == 0)
+            {
+                skiplist_insert(task->skiplist, key);
+            }
+            else if (op == 1)
+            {
+                skiplist_remove(task->skiplist, key);
+            }
+            else
+            {
+                skiplist_contains(task->skiplist, key);
+            }
+            continue;
+        }
+        pthread_mutex_lock(task->mutex);
+        if (op == 0)
+        {
+            if (!bst_contains(task->bst, key))
+            {
+                bst_insert(task->bst, key);
+            }
+        }
+        else if (op == 1)
+        {
+            bst_remove(task->bst, key);
+        }
+        else
+        {
+            bst_contains(task->bst, key);
+        }
+        pthread_mutex_unlock(task->mutex);
+    }
+    return NULL;
+}
+
+static double bench(const uint64_t thread_count, const bool is_skiplist)
+{
+    struct skiplist* skiplist = is_skiplist ? skiplist_create() : NULL;
+    struct bst* bst = is_skiplist ? NULL : bst_create(true);
+    pthread_mutex_t mutex = PTHREAD_MUTEX_INITIALIZER;
+    for (int64_t key = 0; key < BENCH_KEY_RANGE; key += 2)
+    {
+        if (is_skiplist)
+        {
+            skiplist_insert(skiplist, key);
+        }
+        else
+        {
+            bst_insert(bst, key);
+        }
+    }
+
+    pthread_t threads[BENCH_MAX_THREADS];
+    struct bench_task tasks[BENCH_MAX_THREADS];
+    double start = bench_now();
+    for (uint64_t i = 0; i < thread_count; i++)
+    {
+        tasks[i] = (struct bench_task){ skiplist, bst, &mutex, i * 2654435761ULL + 1, i, thread_count, false };
+        pthread_create(&threads[i], NULL, bench_worker, &tasks[i]);
+    }
+    for (uint64_t i = 0; i < thread_count; i++)
+    {
+        pthread_join(threads[i], NULL);
+    }
+    double seconds = bench_now() - start;
+
+    if (is_skiplist)
+    {
+        skiplist_destroy(skiplist);
+    }
+    else
+    {
+        bst_destroy(bst);
+    }
+    return thread_count * BENCH_OPS_PER_THREAD / seconds / 1e6;
+}
+
+int main(int argc, char** argv)
+{
+    long max_threads = argc > 1 ? atol(argv[1]) : sysconf(_SC_NPROCESSORS_ONLN);
+    max_threads = max_threads < 1 ? 1 : max_threads > BENCH_MAX_THREADS ? BENCH_MAX_THREADS : max_threads;
+
+    if (!stress(max_threads < 8 ? 8 : max_threads))
+    {
+        return 1;
+    }
+    printf("threads  skiplist Mops/s  avl+mutex Mops/s\n");
+    for (long thread_count = 1; thread_count <= max_threads; thread_count *= 2)
+    {
+        printf("%7ld  %15.2f  %16.2f\n", thread_count, bench(thread_count, true), bench(thread_count, false));
+    }
+    return 0;
+}
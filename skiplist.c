@@ -0,0 +1,433 @@
+#include "skiplist.h"
+
+#define SKIPLIST_MARK ((uintptr_t)1)
+#define SKIPLIST_LINKED 1
+#define SKIPLIST_REMOVED 2
+
+struct skiplist_range_context
+{
+    struct list* list;
+    bool failed;
+};
+
+
+static struct skiplist_node* skiplist_pointer(const uintptr_t link)
+{
+    return (struct skiplist_node*)(link & ~SKIPLIST_MARK);
+}
+
+static bool skiplist_is_marked(const uintptr_t link)
+{
+    return link & SKIPLIST_MARK;
+}
+
+static uint8_t skiplist_random_level(void)
+{
+    static _Thread_local uint64_t state = 0;
+    if (state == 0)
+    {
+        state = (uint64_t)(uintptr_t)&state ^ 0x9E3779B97F4A7C15ULL;
+    }
+    state ^= state << 13;
+    state ^= state >> 7;
+    state ^= state << 17;
+    return __builtin_ctzll(state | (1ULL << (SKIPLIST_MAX_LEVEL - 1)));
+}
+
+static struct skiplist_node* skiplist_node_create(const int64_t key, const uint8_t top_level)
+{
+    struct skiplist_node* node = malloc(sizeof(struct skiplist_node) + (top_level + 1) * sizeof(_Atomic uintptr_t));
+    if (!node)
+    {
+        fprintf(stderr, "skiplist_node_create: node malloc failed\n");
+        return NULL;
+    }
+    node->key = key;
+    node->top_level = top_level;
+    atomic_init(&node->state, 0);
+    node->retired_epoch = 0;
+    node->retired_next = NULL;
+    for (uint8_t level = 0; level <= top_level; level++)
+    {
+        atomic_init(&node->next[level], 0);
+    }
+    return node;
+}
+
+struct skiplist* skiplist_create(void)
+{
+    struct skiplist* skiplist = calloc(1, sizeof(struct skiplist));
+    if (!skiplist)
+    {
+        fprintf(stderr, "skiplist_create: skiplist malloc failed\n");
+        return NULL;
+    }
+    skiplist->head = skiplist_node_create(INT64_MIN, SKIPLIST_MAX_LEVEL - 1);
+    if (!skiplist->head)
+    {
+        free(skiplist);
+        return NULL;
+    }
+    atomic_init(&skiplist->count, 0);
+    atomic_init(&skiplist->epoch, 1);
+    atomic_init(&skiplist->retired_count, 0);
+    atomic_init(&skiplist->retired, NULL);
+    for (uint32_t i = 0; i < SKIPLIST_MAX_THREADS; i++)
+    {
+        atomic_init(&skiplist->reservations[i], 0);
+    }
+    return skiplist;
+}
+
+void skiplist_destroy(struct skiplist* skiplist)
+{
+    struct skiplist_node* node = skiplist_pointer(atomic_load(&skiplist->head->next[0]));
+    while (node != NULL)
+    {
+        uintptr_t next = atomic_load(&node->next[0]);
+        if (!skiplist_is_marked(next))
+        {
+            free(node);
+        }
+        node = skiplist_pointer(next);
+    }
+    node = atomic_load(&skiplist->retired);
+    while (node != NULL)
+    {
+        struct skiplist_node* next = node->retired_next;
+        free(node);
+        node = next;
+    }
+    free(skiplist->head);
+    free(skiplist);
+}
+
+
+static uint32_t skiplist_enter(struct skiplist* skiplist)
+{
+    static _Thread_local uint32_t hint = 0;
+    uint32_t slot = hint;
+    while (true)
+    {
+        uint_fast64_t expected = 0;
+        if (atomic_compare_exchange_strong(&skiplist->reservations[slot], &expected, atomic_load(&skiplist->epoch)))
+        {
+            hint = slot;
+            return slot;
+        }
+        slot = (slot + 1) % SKIPLIST_MAX_THREADS;
+    }
+}
+
+static void skiplist_exit(struct skiplist* skiplist, const uint32_t slot)
+{
+    atomic_store(&skiplist->reservations[slot], 0);
+}
+
+uint64_t skiplist_reclaim(struct skiplist* skiplist)
+{
+    struct skiplist_node* node = atomic_exchange(&skiplist->retired, NULL);
+    if (node == NULL)
+    {
+        return 0;
+    }
+    uint64_t min_epoch = UINT64_MAX;
+    for (uint32_t i = 0; i < SKIPLIST_MAX_THREADS; i++)
+    {
+        uint64_t epoch = atomic_load(&skiplist->reservations[i]);
+        if (epoch != 0 && epoch < min_epoch)
+        {
+            min_epoch = epoch;
+        }
+    }
+
+    uint64_t freed = 0;
+    struct skiplist_node* kept = NULL;
+    struct skiplist_node* kept_tail = NULL;
+    while (node != NULL)
+    {
+        struct skiplist_node* next = node->retired_next;
+        if (node->retired_epoch < min_epoch)
+        {
+            free(node);
+            freed++;
+        }
+        else
+        {
+            node->retired_next = kept;
+            kept = node;
+            kept_tail = kept_tail == NULL ? node : kept_tail;
+        }
+        node = next;
+    }
+    if (kept != NULL)
+    {
+        kept_tail->retired_next = atomic_load(&skiplist->retired);
+        while (!atomic_compare_exchange_weak(&skiplist->retired, &kept_tail->retired_next, kept))
+        {
+        }
+    }
+    return freed;
+}
+
+
+static bool skiplist_find(struct skiplist* skiplist, const int64_t key, struct skiplist_node** preds, struct skiplist_node** succs, const struct skiplist_node* target)
+{
+retry:
+    ;
+    struct skiplist_node* pred = skiplist->head;
+    struct skiplist_node* curr = NULL;
+    for (int level = SKIPLIST_MAX_LEVEL - 1; level >= 0; level--)
+    {
+        curr = skiplist_pointer(atomic_load(&pred->next[level]));
+        while (curr != NULL)
+        {
+            uintptr_t succ = atomic_load(&curr->next[level]);
+            while (skiplist_is_marked(succ))
+            {
+                uintptr_t expected = (uintptr_t)curr;
+                if (!atomic_compare_exchange_strong(&pred->next[level], &expected, (uintptr_t)skiplist_pointer(succ)))
+                {
+                    goto retry;
+                }
+                curr = skiplist_pointer(succ);
+                if (curr == NULL)
+                {
+                    break;
+                }
+                succ = atomic_load(&curr->next[level]);
+            }
+            if (curr == NULL || curr->key > key || (curr->key == key && target == NULL))
+            {
+                break;
+            }
+            pred = curr;
+            curr = skiplist_pointer(succ);
+        }
+        preds[level] = pred;
+        succs[level] = curr;
+    }
+    return curr != NULL && curr->key == key;
+}
+
+static void skiplist_retire(struct skiplist* skiplist, struct skiplist_node* node)
+{
+    struct skiplist_node* preds[SKIPLIST_MAX_LEVEL];
+    struct skiplist_node* succs[SKIPLIST_MAX_LEVEL];
+    skiplist_find(skiplist, node->key, preds, succs, node);
+    node->retired_epoch = atomic_fetch_add(&skiplist->epoch, 1);
+    node->retired_next = atomic_load(&skiplist->retired);
+    while (!atomic_compare_exchange_weak(&skiplist->retired, &node->retired_next, node))
+    {
+    }
+}
+
+static bool skiplist_link_upper(struct skiplist* skiplist, struct skiplist_node* node, struct skiplist_node** preds, struct skiplist_node** succs)
+{
+    for (uint8_t level = 1; level <= node->top_level; level++)
+    {
+        while (true)
+        {
+            uintptr_t next = atomic_load(&node->next[level]);
+            if (skiplist_is_marked(next))
+            {
+                return false;
+            }
+            if (next != (uintptr_t)succs[level] && !atomic_compare_exchange_strong(&node->next[level], &next, (uintptr_t)succs[level]))
+            {
+                continue;
+            }
+            uintptr_t expected = (uintptr_t)succs[level];
+            if (atomic_compare_exchange_strong(&preds[level]->next[level], &expected, (uintptr_t)node))
+            {
+                break;
+            }
+            if (!skiplist_find(skiplist, node->key, preds, succs, NULL) || succs[0] != node)
+            {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+bool skiplist_insert(struct skiplist* skiplist, const int64_t key)
+{
+    struct skiplist_node* preds[SKIPLIST_MAX_LEVEL];
+    struct skiplist_node* succs[SKIPLIST_MAX_LEVEL];
+    uint8_t top_level = skiplist_random_level();
+    struct skiplist_node* node = NULL;
+    uint32_t slot = skiplist_enter(skiplist);
+    while (true)
+    {
+        if (skiplist_find(skiplist, key, preds, succs, NULL))
+        {
+            skiplist_exit(skiplist, slot);
+            free(node);
+            return false;
+        }
+        if (node == NULL)
+        {
+            node = skiplist_node_create(key, top_level);
+            if (!node)
+            {
+                skiplist_exit(skiplist, slot);
+                return false;
+            }
+        }
+        for (uint8_t level = 0; level <= top_level; level++)
+        {
+            atomic_store(&node->next[level], (uintptr_t)succs[level]);
+        }
+        uintptr_t expected = (uintptr_t)succs[0];
+        if (atomic_compare_exchange_strong(&preds[0]->next[0], &expected, (uintptr_t)node))
+        {
+            break;
+        }
+    }
+    atomic_fetch_add(&skiplist->count, 1);
+
+    skiplist_link_upper(skiplist, node, preds, succs);
+    if (atomic_fetch_or(&node->state, SKIPLIST_LINKED) & SKIPLIST_REMOVED)
+    {
+        skiplist_retire(skiplist, node);
+    }
+    skiplist_exit(skiplist, slot);
+    return true;
+}
+
+bool skiplist_remove(struct skiplist* skiplist, const int64_t key)
+{
+    struct skiplist_node* preds[SKIPLIST_MAX_LEVEL];
+    struct skiplist_node* succs[SKIPLIST_MAX_LEVEL];
+    uint32_t slot = skiplist_enter(skiplist);
+    if (!skiplist_find(skiplist, key, preds, succs, NULL))
+    {
+        skiplist_exit(skiplist, slot);
+        return false;
+    }
+    struct skiplist_node* node = succs[0];
+    for (uint8_t level = node->top_level; level >= 1; level--)
+    {
+        uintptr_t next = atomic_load(&node->next[level]);
+        while (!skiplist_is_marked(next) && !atomic_compare_exchange_strong(&node->next[level], &next, next | SKIPLIST_MARK))
+        {
+        }
+    }
+
+    uintptr_t next = atomic_load(&node->next[0]);
+    while (!skiplist_is_marked(next))
+    {
+        if (atomic_compare_exchange_strong(&node->next[0], &next, next | SKIPLIST_MARK))
+        {
+            if (atomic_fetch_or(&node->state, SKIPLIST_REMOVED) & SKIPLIST_LINKED)
+            {
+                skiplist_retire(skiplist, node);
+            }
+            atomic_fetch_sub(&skiplist->count, 1);
+            skiplist_exit(skiplist, slot);
+            if (atomic_fetch_add(&skiplist->retired_count, 1) % SKIPLIST_RECLAIM_BATCH == SKIPLIST_RECLAIM_BATCH - 1)
+            {
+                skiplist_reclaim(skiplist);
+            }
+            return true;
+        }
+    }
+    skiplist_exit(skiplist, slot);
+    return false;
+}
+
+bool skiplist_contains(struct skiplist* skiplist, const int64_t key)
+{
+    uint32_t slot = skiplist_enter(skiplist);
+    struct skiplist_node* pred = skiplist->head;
+    struct skiplist_node* curr = NULL;
+    for (int level = SKIPLIST_MAX_LEVEL - 1; level >= 0; level--)
+    {
+        curr = skiplist_pointer(atomic_load(&pred->next[level]));
+        while (curr != NULL)
+        {
+            uintptr_t succ = atomic_load(&curr->next[level]);
+            while (skiplist_is_marked(succ))
+            {
+                curr = skiplist_pointer(succ);
+                if (curr == NULL)
+                {
+                    break;
+                }
+                succ = atomic_load(&curr->next[level]);
+            }
+            if (curr == NULL || curr->key >= key)
+            {
+                break;
+            }
+            pred = curr;
+            curr = skiplist_pointer(succ);
+        }
+    }
+    bool found = curr != NULL && curr->key == key && !skiplist_is_marked(atomic_load(&curr->next[0]));
+    skiplist_exit(skiplist, slot);
+    return found;
+}
+
+uint64_t skiplist_count(const struct skiplist* skiplist)
+{
+    return atomic_load(&((struct skiplist*)skiplist)->count);
+}
+
+
+void skiplist_for_each_range(struct skiplist* skiplist, const int64_t from, const int64_t to, bool (*callback)(const int64_t key, void* context), void* context)
+{
+    uint32_t slot = skiplist_enter(skiplist);
+    struct skiplist_node* pred = skiplist->head;
+    for (int level = SKIPLIST_MAX_LEVEL - 1; level >= 0; level--)
+    {
+        struct skiplist_node* curr = skiplist_pointer(atomic_load(&pred->next[level]));
+        while (curr != NULL && curr->key < from)
+        {
+            pred = curr;
+            curr = skiplist_pointer(atomic_load(&curr->next[level]));
+        }
+    }
+
+    struct skiplist_node* node = skiplist_pointer(atomic_load(&pred->next[0]));
+    while (node != NULL && node->key <= to)
+    {
+        uintptr_t next = atomic_load(&node->next[0]);
+        if (!skiplist_is_marked(next) && node->key >= from && !callback(node->key, context))
+        {
+            break;
+        }
+        node = skiplist_pointer(next);
+    }
+    skiplist_exit(skiplist, slot);
+}
+
+static bool skiplist_append_key(const int64_t key, void* context)
+{
+    struct skiplist_range_context* range = context;
+    if (range->list->count == range->list->size && !list_reserve(range->list, range->list->size * 2))
+    {
+        range->failed = true;
+        return false;
+    }
+    list_append(range->list, (void*)key);
+    return true;
+}
+
+struct list* skiplist_get_range(struct skiplist* skiplist, const int64_t from, const int64_t to)
+{
+    struct skiplist_range_context range = { list_create(32), false };
+    if (!range.list)
+    {
+        return NULL;
+    }
+    skiplist_for_each_range(skiplist, from, to, skiplist_append_key, &range);
+    if (range.failed)
+    {
+        fprintf(stderr, "skiplist_get_range: list grow failed\n");
+        list_destroy(range.list);
+        return NULL;
+    }
+    return range.list;
+}
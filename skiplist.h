@@ -0,0 +1,62 @@
+#ifndef SKIPLIST_H
+#define SKIPLIST_H
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdatomic.h>
+#include "list.h"
+
+#define SKIPLIST_MAX_LEVEL 32
+#define SKIPLIST_MAX_THREADS 128
+#define SKIPLIST_RECLAIM_BATCH 256
+
+struct skiplist_node
+{
+    int64_t key;
+    uint8_t top_level;
+    atomic_uint_fast8_t state;
+    uint64_t retired_epoch;
+    struct skiplist_node* retired_next;
+    _Atomic uintptr_t next[];
+};
+
+struct skiplist
+{
+    struct skiplist_node* head;
+    atomic_uint_fast64_t count;
+    atomic_uint_fast64_t epoch;
+    atomic_uint_fast64_t retired_count;
+    _Atomic(struct skiplist_node*) retired;
+    atomic_uint_fast64_t reservations[SKIPLIST_MAX_THREADS];
+};
+
+struct skiplist* skiplist_create(void);
+// Not thread-safe: no other operation may run concurrently.
+void skiplist_destroy(struct skiplist* skiplist);
+
+// Lock-free. Each call holds one of SKIPLIST_MAX_THREADS epoch slots while it
+// runs; more concurrent callers than that spin until a slot frees up.
+bool skiplist_insert(struct skiplist* skiplist, const int64_t key);
+bool skiplist_remove(struct skiplist* skiplist, const int64_t key);
+// Wait-free traversal; never writes to or retries on the list.
+bool skiplist_contains(struct skiplist* skiplist, const int64_t key);
+uint64_t skiplist_count(const struct skiplist* skiplist);
+
+// Removed nodes are freed by epoch-based reclamation once no in-flight
+// operation can still reach them. skiplist_remove calls this every
+// SKIPLIST_RECLAIM_BATCH removes; it is safe to call at any time from any
+// thread and returns the number of nodes freed. A stalled or long-running
+// operation (including a range scan callback) delays reclamation until it
+// returns.
+uint64_t skiplist_reclaim(struct skiplist* skiplist);
+
+// Weakly consistent, not linearizable: keys are reported in ascending order
+// without duplicates, every key present for the whole scan is reported, and a
+// key inserted or removed concurrently may or may not be reported.
+// skiplist_get_range returns NULL if the result list cannot grow.
+struct list* skiplist_get_range(struct skiplist* skiplist, const int64_t from, const int64_t to);
+void skiplist_for_each_range(struct skiplist* skiplist, const int64_t from, const int64_t to, bool (*callback)(const int64_t key, void* context), void* context);
+
+#endif
@@ -0,0 +1,172 @@
+#include "vector.h"
+#include "simd.h"
+
+
+static bool vector_int64_realloc(struct vector_int64* vector, const uint64_t size)
+{
+    int64_t* tmp = realloc(vector->data, size * sizeof(int64_t));
+    if (!tmp)
+    {
+        fprintf(stderr, "vector_int64_realloc: realloc failed\n");
+        return false;
+    }
+    vector->data = tmp;
+    vector->size = size;
+    return true;
+}
+
+struct vector_int64* vector_int64_create(const uint64_t size)
+{
+    struct vector_int64* vector = calloc(1, sizeof(struct vector_int64));
+    if (!vector)
+    {
+        fprintf(stderr, "vector_int64_create: vector malloc failed\n");
+        return NULL;
+    }
+
+    vector->size = size > 0 ? size : 1;
+    vector->count = 0;
+    vector->data = malloc(vector->size * sizeof(int64_t));
+
+    if (!vector->data)
+    {
+        fprintf(stderr, "vector_int64_create: data malloc failed\n");
+        free(vector);
+        return NULL;
+    }
+
+    return vector;
+}
+
+struct vector_int64* vector_int64_create_from_list(const struct list* list)
+{
+    struct vector_int64* vector = vector_int64_create(list->count);
+    if (!vector)
+    {
+        return NULL;
+    }
+    for (uint64_t i = 0; i < list->count; i++)
+    {
+        vector->data[i] = (int64_t)list->data[1 + i];
+    }
+    vector->count = list->count;
+    return vector;
+}
+
+void vector_int64_destroy(struct vector_int64* vector)
+{
+    free(vector->data);
+    free(vector);
+}
+
+
+void vector_int64_append(struct vector_int64* vector, const int64_t value)
+{
+    if (vector->count >= vector->size && !vector_int64_realloc(vector, vector->size * 2))
+    {
+        return;
+    }
+    vector->data[vector->count++] = value;
+}
+
+void vector_int64_append_array(struct vector_int64* vector, const int64_t* values, const uint64_t count)
+{
+    if (vector->count + count > vector->size)
+    {
+        uint64_t size = vector->size * 2 > vector->count + count ? vector->size * 2 : vector->count + count;
+        if (!vector_int64_realloc(vector, size))
+        {
+            return;
+        }
+    }
+    memcpy(vector->data + vector->count, values, count * sizeof(int64_t));
+    vector->count += count;
+}
+
+void vector_int64_replace(struct vector_int64* vector, const int64_t value, const uint64_t index)
+{
+    if (index >= vector->count)
+    {
+        fprintf(stderr, "vector_int64_replace: index out of bounds\n");
+        return;
+    }
+    vector->data[index] = value;
+}
+
+int64_t vector_int64_pop(struct vector_int64* vector)
+{
+    if (vector->count == 0)
+    {
+        fprintf(stderr, "vector_int64_pop: vector is empty\n");
+        return 0;
+    }
+    return vector->data[--vector->count];
+}
+
+void vector_int64_clear(struct vector_int64* vector)
+{
+    vector->count = 0;
+}
+
+
+int64_t vector_int64_get(const struct vector_int64* vector, const uint64_t index)
+{
+    if (index >= vector->count)
+    {
+        fprintf(stderr, "vector_int64_get: index out of bounds: %llu\n", index);
+        return 0;
+    }
+    return vector->data[index];
+}
+
+uint64_t vector_int64_find(const struct vector_int64* vector, const int64_t value)
+{
+    return simd_find_int64(vector->data, vector->count, value);
+}
+
+bool vector_int64_contains(const struct vector_int64* vector, const int64_t value)
+{
+    return simd_find_int64(vector->data, vector->count, value) < vector->count;
+}
+
+
+int64_t vector_int64_get_min(const struct vector_int64* vector)
+{
+    if (vector->count == 0)
+    {
+        fprintf(stderr, "vector_int64_get_min: vector is empty\n");
+        return 0;
+    }
+    return simd_min_int64(vector->data, vector->count);
+}
+
+int64_t vector_int64_get_max(const struct vector_int64* vector)
+{
+    if (vector->count == 0)
+    {
+        fprintf(stderr, "vector_int64_get_max: vector is empty\n");
+        return 0;
+    }
+    return simd_max_int64(vector->data, vector->count);
+}
+
+int64_t vector_int64_sum(const struct vector_int64* vector)
+{
+    return simd_sum_int64(vector->data, vector->count);
+}
+
+bool vector_int64_is_sorted(const struct vector_int64* vector)
+{
+    return simd_is_sorted_int64(vector->data, vector->count);
+}
+
+
+void vector_int64_print(const struct vector_int64* vector)
+{
+    printf("(");
+    for (uint64_t i = 0; i < vector->count; i++)
+    {
+        printf(i == vector->count - 1 ? "%lld" : "%lld, ", vector->data[i]);
+    }
+    printf(")");
+}
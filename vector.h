@@ -0,0 +1,40 @@
+#ifndef VECTOR_H
+#define VECTOR_H
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include "list.h"
+
+#define vector(T) vector_int64_create(32)
+
+struct vector_int64
+{
+    uint64_t size;
+    uint64_t count;
+    int64_t* data;
+};
+
+struct vector_int64* vector_int64_create(const uint64_t size);
+struct vector_int64* vector_int64_create_from_list(const struct list* list);
+void vector_int64_destroy(struct vector_int64* vector);
+
+void vector_int64_append(struct vector_int64* vector, const int64_t value);
+void vector_int64_append_array(struct vector_int64* vector, const int64_t* values, const uint64_t count);
+void vector_int64_replace(struct vector_int64* vector, const int64_t value, const uint64_t index);
+int64_t vector_int64_pop(struct vector_int64* vector);
+void vector_int64_clear(struct vector_int64* vector);
+
+int64_t vector_int64_get(const struct vector_int64* vector, const uint64_t index);
+uint64_t vector_int64_find(const struct vector_int64* vector, const int64_t value);
+bool vector_int64_contains(const struct vector_int64* vector, const int64_t value);
+
+int64_t vector_int64_get_min(const struct vector_int64* vector);
+int64_t vector_int64_get_max(const struct vector_int64* vector);
+int64_t vector_int64_sum(const struct vector_int64* vector);
+bool vector_int64_is_sorted(const struct vector_int64* vector);
+
+void vector_int64_print(const struct vector_int64* vector);
+
+#endif